@@ -1,15 +1,7 @@
 package.path = package.path .. ";assets/scripts/?.lua"
 
-Dusk = { }
+-- Dusk.Vec3, Dusk.App, Dusk.Scene, Dusk.Actor, Dusk.Component and
+-- Dusk.Camera are native types registered by the engine
+if not Dusk then Dusk = { } end
 
 require "dusk/Class"
-
-Dusk.Object = Dusk.Class(function(self, ptr)
-    self.dusk_ptr = ptr
-end)
-
-require "dusk/Events"
-require "dusk/Actor"
-require "dusk/Component"
-require "dusk/Scene"
-require "dusk/App"
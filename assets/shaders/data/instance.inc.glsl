@@ -0,0 +1,2 @@
+// Only valid in vertex shaders marked "Instanced" in their definition
+layout(location = 4) in mat4 _InstanceModel;
@@ -0,0 +1,225 @@
+// Compares IEventDispatcher against the map-of-vectors dispatcher it replaced
+// at 10, 1k and 100k listeners.
+
+#include <dusk/EventDispatcher.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+using namespace dusk;
+
+// The previous implementation, kept verbatim in behaviour for comparison
+class LegacyEventDispatcher
+{
+public:
+
+    ~LegacyEventDispatcher()
+    {
+        for (auto it : _eventListeners)
+        {
+            for (IEventCallback * callback : it.second)
+            {
+                delete callback;
+            }
+        }
+    }
+
+    template <typename ObjectType, typename MethodType>
+    void AddEventListener(const EventID& eventId, ObjectType * object, MethodType method)
+    {
+        if (_eventListeners.find(eventId) == _eventListeners.end())
+        {
+            _eventListeners.emplace(eventId, std::vector<IEventCallback *>());
+        }
+
+        _eventListeners[eventId].push_back(new MethodEventCallback<ObjectType, MethodType>(object, method));
+    }
+
+    template <typename ObjectType, typename MethodType>
+    void RemoveEventListener(const EventID& eventId, ObjectType * object, MethodType method)
+    {
+        MethodEventCallback<ObjectType, MethodType> tmp(object, method);
+
+        const auto& listIt = _eventListeners.find(eventId);
+        if (listIt == _eventListeners.end()) return;
+
+        if (_deadEventListeners.find(eventId) == _deadEventListeners.end())
+        {
+            _deadEventListeners.emplace(eventId, std::vector<IEventCallback *>());
+        }
+
+        for (IEventCallback * callback : listIt->second)
+        {
+            if (*callback == tmp)
+            {
+                _deadEventListeners[eventId].push_back(callback);
+                return;
+            }
+        }
+    }
+
+    void DispatchEvent(const Event& event)
+    {
+        const auto& listIt = _eventListeners.find(event.GetID());
+        if (listIt == _eventListeners.end()) return;
+
+        for (const auto& listener : listIt->second)
+        {
+            if (_deadEventListeners.find(event.GetID()) != _deadEventListeners.end())
+            {
+                bool dead = false;
+                for (IEventCallback * callback : _deadEventListeners[event.GetID()])
+                {
+                    if (listener == callback)
+                    {
+                        dead = true;
+                    }
+                }
+                if (dead)
+                    continue;
+            }
+            listener->Invoke(event);
+        }
+
+        for (auto deadEventList : _deadEventListeners)
+        {
+            auto& eventList = _eventListeners[deadEventList.first];
+            for (IEventCallback * deadCallback : deadEventList.second)
+            {
+                for (auto it = eventList.begin(); it != eventList.end(); ++it)
+                {
+                    if (*it == deadCallback)
+                    {
+                        delete deadCallback;
+                        std::swap(*it, eventList.back());
+                        eventList.pop_back();
+                        break;
+                    }
+                }
+            }
+        }
+        _deadEventListeners.clear();
+    }
+
+private:
+
+    std::unordered_map<EventID, std::vector<IEventCallback *>> _eventListeners;
+    std::unordered_map<EventID, std::vector<IEventCallback *>> _deadEventListeners;
+
+}; // class LegacyEventDispatcher
+
+struct Counter
+{
+    unsigned long long count = 0;
+
+    void OnEvent(const Event& event) { ++count; }
+};
+
+static const EventID BENCH_EVENT = 1;
+
+// Keeps the total number of listener calls roughly constant across sizes
+static const size_t CALLS_PER_RUN = 20000000;
+
+static void Add(LegacyEventDispatcher& dispatcher, Counter& counter, std::vector<EventListenerID>& ids)
+{
+    dispatcher.AddEventListener(BENCH_EVENT, &counter, &Counter::OnEvent);
+}
+
+static void Add(IEventDispatcher& dispatcher, Counter& counter, std::vector<EventListenerID>& ids)
+{
+    ids.push_back(dispatcher.AddEventListener(BENCH_EVENT, &counter, &Counter::OnEvent));
+}
+
+static void Remove(LegacyEventDispatcher& dispatcher, Counter& counter, const EventListenerID& id, bool byId)
+{
+    dispatcher.RemoveEventListener(BENCH_EVENT, &counter, &Counter::OnEvent);
+}
+
+static void Remove(IEventDispatcher& dispatcher, Counter& counter, const EventListenerID& id, bool byId)
+{
+    if (byId)
+    {
+        dispatcher.RemoveEventListener(id);
+    }
+    else
+    {
+        dispatcher.RemoveEventListener(BENCH_EVENT, &counter, &Counter::OnEvent);
+    }
+}
+
+template <typename Dispatcher>
+static void Run(const char * name, size_t listenerCount, bool byId = false)
+{
+    typedef std::chrono::duration<double, std::milli> Millis;
+
+    std::vector<Counter> counters(listenerCount);
+    std::vector<EventListenerID> ids;
+    ids.reserve(listenerCount);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    {
+        Dispatcher dispatcher;
+
+        for (Counter& counter : counters)
+        {
+            Add(dispatcher, counter, ids);
+        }
+
+        auto added = std::chrono::high_resolution_clock::now();
+
+        size_t dispatches = (CALLS_PER_RUN / listenerCount > 0 ? CALLS_PER_RUN / listenerCount : 1);
+        for (size_t i = 0; i < dispatches; ++i)
+        {
+            dispatcher.DispatchEvent(Event(BENCH_EVENT));
+        }
+
+        auto dispatched = std::chrono::high_resolution_clock::now();
+
+        // Remove every tenth listener by value, or through the returned ids,
+        // then dispatch once to flush the removals
+        for (size_t i = 0; i < listenerCount; i += 10)
+        {
+            Remove(dispatcher, counters[i], (ids.empty() ? EventListenerID() : ids[i]), byId);
+        }
+        dispatcher.DispatchEvent(Event(BENCH_EVENT));
+
+        auto removed = std::chrono::high_resolution_clock::now();
+
+        double dispatchNs = Millis(dispatched - added).count() * 1e6 / (double)(dispatches * listenerCount);
+
+        printf("%-8s %7zu listeners  add %9.3f ms  dispatch %7.2f ns/call  remove %10.3f ms\n",
+               name, listenerCount,
+               Millis(added - start).count(),
+               dispatchNs,
+               Millis(removed - dispatched).count());
+    }
+
+    unsigned long long total = 0;
+    for (const Counter& counter : counters)
+    {
+        total += counter.count;
+    }
+
+    // Stops the calls from being optimized away
+    if (0 == total)
+    {
+        printf("no listeners were called\n");
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    const size_t sizes[] = { 10, 1000, 100000 };
+
+    for (size_t size : sizes)
+    {
+        Run<LegacyEventDispatcher>("legacy", size);
+        Run<IEventDispatcher>("current", size);
+        Run<IEventDispatcher>("by id", size, true);
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Compares Lua allocations and call cost of reading actor transforms through
+// the raw functions the bindings used to be, the Vec3 getters and the *XYZ
+// getters, for 1k actors read once per frame.
+
+#include <dusk/Config.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+static const int ACTOR_COUNT = 1000;
+static const int FRAME_COUNT = 1000;
+
+// Stands in for Actor, bound the same way Actor::BindScripting does
+struct BenchActor
+{
+    glm::vec3 position;
+
+    glm::vec3 GetPosition() const { return position; }
+};
+
+struct AllocStats
+{
+    size_t count = 0;
+};
+
+static void * CountingAlloc(void * ud, void * ptr, size_t osize, size_t nsize)
+{
+    if (0 == nsize)
+    {
+        free(ptr);
+        return nullptr;
+    }
+
+    if (!ptr)
+    {
+        ++static_cast<AllocStats *>(ud)->count;
+    }
+
+    return realloc(ptr, nsize);
+}
+
+// How the baseline read positions, a pointer passed as an integer
+static int Legacy_GetPosition(lua_State * L)
+{
+    BenchActor * actor = (BenchActor *)lua_tointeger(L, 1);
+    glm::vec3 pos = actor->GetPosition();
+
+    lua_pushnumber(L, pos.x);
+    lua_pushnumber(L, pos.y);
+    lua_pushnumber(L, pos.z);
+
+    return 3;
+}
+
+static const char * LEGACY_SCRIPT =
+    "local actors, frames = ...\n"
+    "local sum = 0\n"
+    "for f = 1, frames do\n"
+    "    for i = 1, #actors do\n"
+    "        local x, y, z = legacy_GetPosition(actors[i])\n"
+    "        sum = sum + x\n"
+    "    end\n"
+    "end\n"
+    "return sum\n";
+
+static const char * VEC3_SCRIPT =
+    "local actors, frames = ...\n"
+    "local sum = 0\n"
+    "for f = 1, frames do\n"
+    "    for i = 1, #actors do\n"
+    "        local pos = actors[i]:GetPosition()\n"
+    "        sum = sum + pos.x\n"
+    "    end\n"
+    "end\n"
+    "return sum\n";
+
+static const char * XYZ_SCRIPT =
+    "local actors, frames = ...\n"
+    "local sum = 0\n"
+    "for f = 1, frames do\n"
+    "    for i = 1, #actors do\n"
+    "        local x, y, z = actors[i]:GetPositionXYZ()\n"
+    "        sum = sum + x\n"
+    "    end\n"
+    "end\n"
+    "return sum\n";
+
+static void Run(const char * name, const char * script, bool legacy)
+{
+    typedef std::chrono::duration<double, std::milli> Millis;
+
+    AllocStats stats;
+    lua_State * L = lua_newstate(&CountingAlloc, &stats);
+    luaL_openlibs(L);
+
+    {
+        sol::state_view lua(L);
+
+        lua.new_usertype<glm::vec3>("Vec3",
+            "x", &glm::vec3::x,
+            "y", &glm::vec3::y,
+            "z", &glm::vec3::z);
+
+        lua.new_usertype<BenchActor>("BenchActor",
+            "new", sol::no_constructor,
+            "GetPosition", &BenchActor::GetPosition,
+            "GetPositionXYZ", [](const BenchActor& actor) {
+                glm::vec3 value = actor.GetPosition();
+                return std::make_tuple(value.x, value.y, value.z);
+            });
+
+        lua_register(L, "legacy_GetPosition", &Legacy_GetPosition);
+
+        std::vector<BenchActor> actors(ACTOR_COUNT);
+        sol::table list = lua.create_table(ACTOR_COUNT, 0);
+        for (int i = 0; i < ACTOR_COUNT; ++i)
+        {
+            actors[i].position = glm::vec3((float)i, 0.0f, 0.0f);
+
+            if (legacy)
+            {
+                list[i + 1] = (lua_Integer)&actors[i];
+            }
+            else
+            {
+                list[i + 1] = &actors[i];
+            }
+        }
+
+        sol::protected_function chunk = lua.load(script);
+
+        // Everything after this is the loop itself
+        lua_gc(L, LUA_GCCOLLECT, 0);
+        size_t before = stats.count;
+        auto start = std::chrono::high_resolution_clock::now();
+
+        sol::protected_function_result result = chunk(list, FRAME_COUNT);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        size_t allocs = stats.count - before;
+
+        if (!result.valid())
+        {
+            sol::error err = result;
+            printf("%-8s failed: %s\n", name, err.what());
+        }
+
+        double calls = (double)ACTOR_COUNT * FRAME_COUNT;
+        printf("%-8s %9.1f allocations/frame  %7.2f ns/call  %8.1f KB Lua heap\n",
+               name,
+               (double)allocs / FRAME_COUNT,
+               Millis(end - start).count() * 1e6 / calls,
+               lua_gc(L, LUA_GCCOUNT, 0) + lua_gc(L, LUA_GCCOUNTB, 0) / 1024.0);
+    }
+
+    lua_close(L);
+}
+
+int main(int argc, char ** argv)
+{
+    Run("legacy", LEGACY_SCRIPT, true);
+    Run("Vec3", VEC3_SCRIPT, false);
+    Run("XYZ", XYZ_SCRIPT, false);
+
+    return 0;
+}
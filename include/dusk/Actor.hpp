@@ -5,6 +5,9 @@
 
 #include <dusk/EventDispatcher.hpp>
 #include <dusk/Component.hpp>
+#include <dusk/Bounds.hpp>
+#include <dusk/BVH.hpp>
+#include <dusk/TransformPool.hpp>
 #include <memory>
 
 namespace dusk {
@@ -39,29 +42,51 @@ public:
     void SetBaseTransform(const glm::mat4& baseTransform);
 
     void SetPosition(const glm::vec3& pos);
-    inline glm::vec3 GetPosition() const { return _position; }
+    inline glm::vec3 GetPosition() const { return _transformPool->GetPosition(_transformHandle); }
 
     void SetRotation(const glm::vec3& rot);
-    inline glm::vec3 GetRotation() const { return _rotation; }
+    inline glm::vec3 GetRotation() const { return _transformPool->GetRotation(_transformHandle); }
 
     void SetScale(const glm::vec3& scale);
-    inline glm::vec3 GetScale() const { return _scale; }
+    inline glm::vec3 GetScale() const { return _transformPool->GetScale(_transformHandle); }
 
-    glm::mat4 GetTransform();
+    // World matrix as of the last transform pool update
+    inline glm::mat4 GetTransform() const { return _transformPool->GetWorld(_transformHandle); }
+
+    inline unsigned int GetTransformHandle() const { return _transformHandle; }
+
+    // Position, rotation and scale become relative to the parent. Actors are
+    // still owned by the scene, the link is cleared when either side is destroyed
+    void SetParent(Actor * parent);
+    inline Actor * GetParent() const { return _parent; }
+
+    inline const std::vector<Actor *>& GetChildren() const { return _children; }
+
+    // Rebuilds the world space union of the components' bounds
+    void UpdateBounds();
+    const AABB& GetWorldBounds() const { return _worldBounds; }
+
+    // Leaf in the scene's BVH, managed by the scene
+    void SetBVHProxy(int proxy) { _bvhProxy = proxy; }
+    int GetBVHProxy() const { return _bvhProxy; }
 
     void AddComponent(std::unique_ptr<Component> comp);
 
+    // Called directly by the scene, events are only built if someone listens
     virtual void Update(const Event& event);
     virtual void Render(const Event& event);
 
     static void InitScripting();
+    static void BindScripting(lua_State * L);
 
-    static int Script_GetPosition(lua_State * L);
-    static int Script_SetPosition(lua_State * L);
-    static int Script_GetRotation(lua_State * L);
-    static int Script_SetRotation(lua_State * L);
-    static int Script_GetScale(lua_State * L);
-    static int Script_SetScale(lua_State * L);
+    // Bulk transforms, (actors, values) where actors is an array of actors and
+    // values a FloatBuffer or array of numbers with x, y, z for each actor
+    static int Script_SetPositions(lua_State * L);
+    static int Script_GetPositions(lua_State * L);
+    static int Script_SetRotations(lua_State * L);
+    static int Script_GetRotations(lua_State * L);
+    static int Script_SetScales(lua_State * L);
+    static int Script_GetScales(lua_State * L);
 
 private:
 
@@ -69,11 +94,15 @@ private:
 
     bool _isTemplate;
 
-    glm::mat4 _baseTransform;
-    glm::mat4 _transform;
-    glm::vec3 _position;
-    glm::vec3 _rotation;
-    glm::vec3 _scale;
+    TransformPool * _transformPool;
+    unsigned int _transformHandle;
+
+    Actor * _parent;
+    std::vector<Actor *> _children;
+
+    AABB _worldBounds;
+
+    int _bvhProxy;
 
     std::vector<std::unique_ptr<Component>> _components;
 
@@ -6,7 +6,14 @@
 #include <dusk/Scene.hpp>
 #include <dusk/Asset.hpp>
 #include <dusk/Font.hpp>
-
+#include <dusk/Sound.hpp>
+#include <dusk/TransformPool.hpp>
+#include <dusk/EventBus.hpp>
+#include <dusk/FloatBuffer.hpp>
+#include <dusk/FileWatcher.hpp>
+#include <dusk/FramePacer.hpp>
+
+#include <algorithm>
 #include <string>
 #include <stack>
 #include <unordered_map>
@@ -53,9 +60,7 @@ public:
     std::string WindowTitle   = "Dusk";
 
     static void InitScripting();
-    static int Script_GetInst(lua_State * L);
-    static int Script_LoadConfig(lua_State * L);
-    static int Script_GetScene(lua_State * L);
+    static void BindScripting(lua_State * L);
 
     AssetCache<Texture> * GetTextureCache() const { return _textureCache.get(); }
     AssetIndex<Texture> * GetTextureIndex() const { return _textureIndex.get(); }
@@ -63,6 +68,43 @@ public:
     AssetIndex<Mesh> * GetMeshIndex() const { return _meshIndex.get(); }
     AssetCache<Material> * GetMaterialCache() const { return _materialCache.get(); }
     AssetIndex<Material> * GetMaterialIndex() const { return _materialIndex.get(); }
+    AssetCache<Sound> * GetSoundCache() const { return _soundCache.get(); }
+    AssetIndex<Sound> * GetSoundIndex() const { return _soundIndex.get(); }
+
+    AssetLoader * GetAssetLoader() const { return _assetLoader.get(); }
+
+    // Workers for jobs the main thread waits on within a frame, shared by the
+    // transform update and parallel scripts, which never run at the same time
+    ThreadPool * GetWorkerPool() const { return _workerPool.get(); }
+
+    EventQueue * GetEventQueue() const { return _eventQueue.get(); }
+
+    // Safe to post into from any thread
+    EventBus * GetEventBus() const { return _eventBus.get(); }
+
+    TransformPool * GetTransformPool() const { return _transformPool.get(); }
+
+    FramePacer * GetFramePacer() const { return _framePacer.get(); }
+
+    // UPDATE is dispatched this many times a second with a fixed time step,
+    // however often we render. 0 updates once per frame with the frame time
+    void SetUpdateRate(double rate);
+    double GetUpdateRate() const { return (_updateStep > 0.0 ? 1.0 / _updateStep : 0.0); }
+
+    // Updates run per frame at most, to catch up after a stall. Time beyond
+    // that is dropped, so the simulation slows down instead of falling further behind
+    void SetMaxUpdateSteps(unsigned int steps) { _maxUpdateSteps = std::max(1u, steps); }
+    unsigned int GetMaxUpdateSteps() const { return _maxUpdateSteps; }
+
+    // Milliseconds of updates dropped so far, and on how many frames
+    double GetDroppedUpdateTime() const { return _droppedUpdateTime; }
+    unsigned int GetDroppedUpdateFrames() const { return _droppedUpdateFrames; }
+
+    // How far the frame being rendered is between the last two updates
+    float GetInterpolationAlpha() const { return _interpolationAlpha; }
+
+    // Assets register here to reload when their files change
+    FileWatcher * GetFileWatcher() const { return _fileWatcher.get(); }
 
     GLFWwindow * GetGLFWWindow() const { return _glfwWindow; }
 
@@ -81,7 +123,24 @@ private:
     void CreateWindow();
     void DestroyWindow();
 
-    const float TARGET_FPS = 60.0f;
+    // One UPDATE, and everything that has to follow it
+    void Step(UpdateEventData& updateEventData, double elapsed);
+
+    static const double DEFAULT_UPDATE_RATE;
+
+    double _updateStep;
+    double _updateAccumulator;
+    unsigned int _maxUpdateSteps;
+    float _interpolationAlpha;
+
+    double _droppedUpdateTime;
+    unsigned int _droppedUpdateFrames;
+
+    // Set while frames in a row are dropping updates, so it's logged once
+    bool _droppingUpdates;
+
+    // Declared first so it outlives everything that watches files
+    std::unique_ptr<FileWatcher> _fileWatcher;
 
     std::shared_ptr<Font> _defaultFont;
 
@@ -91,6 +150,21 @@ private:
     std::unique_ptr<AssetIndex<Mesh>> _meshIndex;
     std::unique_ptr<AssetCache<Material>> _materialCache;
     std::unique_ptr<AssetIndex<Material>> _materialIndex;
+    std::unique_ptr<AssetCache<Sound>> _soundCache;
+    std::unique_ptr<AssetIndex<Sound>> _soundIndex;
+
+    // Declared before anything that dispatches, so it outlives them
+    std::unique_ptr<EventQueue> _eventQueue;
+    std::unique_ptr<EventBus> _eventBus;
+
+    std::unique_ptr<AssetLoader> _assetLoader;
+
+    // Declared before everything that submits to it
+    std::unique_ptr<ThreadPool> _workerPool;
+
+    std::unique_ptr<TransformPool> _transformPool;
+
+    std::unique_ptr<FramePacer> _framePacer;
 
     std::unordered_map<std::string, std::unique_ptr<Shader>> _shaders;
 
@@ -119,19 +193,21 @@ public:
 
     virtual int PushToLua(lua_State * L) const override;
 
-    void SetTargetFPS(float fps) { _target_fps = fps; }
+    // Delta is elapsed time in units of 1 / rate: the update rate with a
+    // fixed step, so each step is 1.0, otherwise the target FPS
+    void SetDeltaRate(float rate) { _delta_rate = rate; }
     void SetCurrentFPS(float fps) { _current_fps = fps; }
 
     void Update(double elapsed);
 
 private:
 
-    float  _delta;
-    double _elapsed_time;
-    double _total_time;
+    float  _delta = 0.0f;
+    double _elapsed_time = 0.0;
+    double _total_time = 0.0;
 
-    float _target_fps = 60.0f;
-    float  _current_fps;
+    float _delta_rate = 60.0f;
+    float  _current_fps = 0.0f;
 
 }; // class UpdateEventData
 
@@ -2,15 +2,14 @@
 #define DUSK_ASSET_HPP
 
 #include <dusk/Config.hpp>
+#include <dusk/ThreadPool.hpp>
+#include <dusk/MPSCQueue.hpp>
 
 #include <string>
 #include <memory>
 #include <vector>
 #include <unordered_map>
-#include <queue>
-#include <mutex>
-#include <thread>
-#include <type_traits>
+#include <atomic>
 
 namespace dusk
 {
@@ -88,59 +87,68 @@ class ILoadable
 {
 public:
 
-    virtual void Load() = 0;
+    virtual ~ILoadable() = default;
 
-    virtual inline bool IsLoaded() const { return _isLoaded; }
+    // Called from an AssetLoader worker, must not touch GL or AL state
+    virtual bool Load() = 0;
 
-private:
+    // Called from the main thread once Load() has succeeded
+    virtual bool Upload() { return true; }
 
-    bool _isLoaded = false;
+    inline bool IsLoaded() const { return _isLoaded; }
 
 protected:
 
-    virtual void SetLoaded(bool loaded) { _isLoaded = loaded; }
+    void SetLoaded(bool loaded) { _isLoaded = loaded; }
+
+private:
+
+    std::atomic<bool> _isLoaded { false };
 
 }; // class ILoadable
 
-template <typename T>
 class AssetLoader
 {
-    static_assert(std::is_base_of<T, ILoadable>::value, "T must derive from ILoadable");
-
 public:
 
-    AssetLoader()
-    {
-        _worker = std::thread(
-            [this](){
-                while (true)
-                {
-                    std::weak_ptr<T> tmp;
-
-                    _queueMutex.lock();
-
-                    if (_loadQueue.empty()) continue;
-                    tmp = _loadQueue.front();
-                    _loadQueue.pop();
-
-                    _queueMutex.unlock();
-
-                    if (std::shared_ptr<T> ptr = tmp.lock())
-                    {
-                        ptr->Load();
-                    }
-                }
-            });
-    }
+    DISALLOW_COPY_AND_ASSIGN(AssetLoader);
+
+    explicit AssetLoader(unsigned int threadCount = ThreadPool::GetDefaultLoaderThreadCount());
+    virtual ~AssetLoader();
+
+    void SetThreadCount(unsigned int threadCount) { _pool.SetThreadCount(threadCount); }
+    unsigned int GetThreadCount() const { return _pool.GetThreadCount(); }
+
+    void Queue(std::shared_ptr<ILoadable> asset);
+
+    // Upload decoded assets until the budget runs out, call from the main thread
+    void ProcessCompleted(double budgetMs = 4.0);
+
+    size_t GetPendingCount() const { return _pendingCount; }
+
+    // How many decoded assets are waiting for the main thread to upload them
+    size_t GetCompletedDepth() const { return _completed.GetSize(); }
 
 private:
 
-    std::thread _worker;
+    // Holds a strong reference once a worker has picked the asset up, so
+    // the last owner, and with it the GL/AL cleanup, is always released on
+    // the main thread
+    struct Completed
+    {
+        std::shared_ptr<ILoadable> asset;
+        bool loaded;
+    };
+
+    std::atomic<size_t> _pendingCount { 0 };
+
+    // Workers block here if the main thread falls too far behind on uploads.
+    // Declared before the pool so it outlives the workers
+    MPSCQueue<Completed> _completed;
 
-    std::mutex _queueMutex;
-    std::queue<std::weak_ptr<T>> _loadQueue;
+    ThreadPool _pool;
 
-}; // class AssetLoader<T>
+}; // class AssetLoader
 
 } // namespace dusk
 
@@ -0,0 +1,116 @@
+#ifndef DUSK_BVH_HPP
+#define DUSK_BVH_HPP
+
+#include <dusk/Config.hpp>
+
+#include <dusk/Bounds.hpp>
+#include <vector>
+
+namespace dusk {
+
+// Dynamic AABB tree. Leaves store a fattened copy of their bounds so small
+// movements don't touch the tree, and the tree is kept balanced with
+// rotations as leaves are inserted. Queries walk the fat bounds but test
+// leaves against the exact ones.
+class BVH
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(BVH);
+
+    static const int NULL_NODE = -1;
+
+    BVH();
+    virtual ~BVH();
+
+    // Returns a proxy id used to move or remove the leaf later
+    int Insert(const AABB& bounds, void * userData);
+
+    void Remove(int proxy);
+
+    // Returns true if the leaf had to be reinserted
+    bool Move(int proxy, const AABB& bounds);
+
+    void * GetUserData(int proxy) const { return _nodes[proxy].userData; }
+
+    const AABB& GetBounds(int proxy) const { return _nodes[proxy].tight; }
+
+    const AABB& GetFatBounds(int proxy) const { return _nodes[proxy].bounds; }
+
+    // Subtrees fully inside the frustum are accepted without testing their
+    // leaves; leaves under partially visible nodes are sphere tested in one batch
+    void QueryFrustum(const Frustum& frustum, std::vector<void *>& results);
+
+    // QueryRadius() and Raycast() can run on several threads at once, as long
+    // as nothing changes the tree meanwhile
+    void QueryRadius(const glm::vec3& center, float radius, std::vector<void *>& results) const;
+
+    // Nearest leaf whose bounds the ray hits, or nullptr
+    void * Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, float * hitDist = nullptr) const;
+
+    size_t GetLeafCount() const { return _leafCount; }
+
+    int GetHeight() const { return (NULL_NODE == _root ? 0 : _nodes[_root].height); }
+
+private:
+
+    struct Node
+    {
+        AABB bounds;
+
+        // Leaves only, the bounds as given to Insert() or Move()
+        AABB tight;
+
+        void * userData;
+
+        // Doubles as the free list link
+        int parent;
+        int left;
+        int right;
+
+        // Leaves are 0, free nodes -1
+        int height;
+
+        inline bool IsLeaf() const { return NULL_NODE == left; }
+    };
+
+    int AllocateNode();
+    void FreeNode(int node);
+
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+
+    int Balance(int node);
+
+    void CollectLeaves(int node, std::vector<void *>& results) const;
+
+    // Slab test, sets t to where the ray enters the box
+    static bool IntersectRay(const AABB& bounds, const glm::vec3& origin, const glm::vec3& invDir,
+                             float maxDist, float& t);
+
+    static float SurfaceArea(const AABB& bounds);
+    static AABB Union(const AABB& lhs, const AABB& rhs);
+
+    std::vector<Node> _nodes;
+    int _root;
+    int _freeList;
+
+    size_t _leafCount;
+
+    // Traversal stacks for QueryFrustum, which only runs on the main thread
+    std::vector<int> _stack;
+    mutable std::vector<int> _collectStack;
+
+    // Leaves that need the per-object test during QueryFrustum
+    std::vector<int> _candidates;
+    std::vector<float> _candX;
+    std::vector<float> _candY;
+    std::vector<float> _candZ;
+    std::vector<float> _candRadius;
+    std::vector<unsigned char> _candVisible;
+
+}; // class BVH
+
+} // namespace dusk
+
+#endif // DUSK_BVH_HPP
@@ -0,0 +1,82 @@
+#ifndef DUSK_BOUNDS_HPP
+#define DUSK_BOUNDS_HPP
+
+#include <dusk/Config.hpp>
+
+#include <cfloat>
+
+namespace dusk {
+
+struct AABB
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    inline bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    inline bool operator==(const AABB& rhs) const { return min == rhs.min && max == rhs.max; }
+    inline bool operator!=(const AABB& rhs) const { return !(*this == rhs); }
+
+    inline glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+    inline glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+    inline void Expand(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    inline void Expand(const AABB& other)
+    {
+        if (other.IsValid())
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+    }
+
+    // Bounds of this box after transform, without touching all eight corners
+    AABB Transform(const glm::mat4& transform) const;
+
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0);
+    float radius = -1.0f;
+
+    inline bool IsValid() const { return radius >= 0.0f; }
+
+    // Smallest sphere containing both
+    void Expand(const BoundingSphere& other);
+
+    BoundingSphere Transform(const glm::mat4& transform) const;
+
+};
+
+struct Frustum
+{
+    enum Result
+    {
+        OUTSIDE,
+        INTERSECT,
+        INSIDE,
+    };
+
+    // Left, right, bottom, top, near, far; normals point inwards
+    glm::vec4 planes[6];
+
+    static Frustum FromMatrix(const glm::mat4& viewProj);
+
+    Result TestAABB(const AABB& bounds) const;
+
+    // Writes 1 to visible[i] if sphere i touches the frustum. The inputs are
+    // separate arrays so the inner loop vectorizes.
+    void TestSpheres(const float * x, const float * y, const float * z, const float * radius,
+                     size_t count, unsigned char * visible) const;
+
+};
+
+} // namespace dusk
+
+#endif // DUSK_BOUNDS_HPP
@@ -46,8 +46,16 @@ public:
 
     void AddVelocity(const glm::vec3& vel);
 
+    // Applies velocity, once per update step
     void Update();
 
+    // Places the view between the positions before and after the last
+    // Update(), alpha as in TransformPool::Interpolate(). Call before GetView()
+    void Interpolate(float alpha);
+
+    static void InitScripting();
+    static void BindScripting(lua_State * L);
+
 private:
 
     glm::mat4 _baseTransform;
@@ -63,6 +71,8 @@ private:
     glm::vec2 _clip;
 
     glm::vec3 _position;
+    glm::vec3 _previousPosition;
+    glm::vec3 _renderPosition;
     glm::vec3 _forward;
     glm::vec3 _up;
 
@@ -6,12 +6,16 @@
 #include <dusk/Model.hpp>
 #include <dusk/Camera.hpp>
 #include <dusk/ScriptHost.hpp>
+#include <dusk/ScriptCommandBuffer.hpp>
+#include <dusk/EventCallbacks.hpp>
 #include <dusk/Event.hpp>
+#include <dusk/ComponentPool.hpp>
 #include <memory>
 
 namespace dusk {
 
 class Actor;
+class Scene;
 
 class Component
 {
@@ -31,8 +35,23 @@ public:
     virtual void SetActor(Actor * actor);
     Actor * GetActor() const { return _actor; };
 
+    // Adds this component's world space bounds, if it has any
+    virtual void ExpandBounds(AABB& bounds) { }
+
+    // Called by the actor when it enters or leaves a scene, components that
+    // need per-frame work register with the scene's pools here
+    virtual void AddToScene(Scene * scene) { }
+    virtual void RemoveFromScene(Scene * scene) { }
+
+    // Called directly by the actor for every visible frame
+    virtual void OnRender(const Event& event) { }
+
+    // Slot in the scene's pool for this component type, managed by the pool
+    void SetPoolIndex(size_t index) { _poolIndex = index; }
+    size_t GetPoolIndex() const { return _poolIndex; }
+
     static void InitScripting();
-    static int Script_GetActor(lua_State * L);
+    static void BindScripting(lua_State * L);
 
 protected:
 
@@ -40,6 +59,8 @@ protected:
 
     bool _isTemplate;
 
+    size_t _poolIndex;
+
 }; // class Component
 
 class ModelComponent : public Component
@@ -53,8 +74,13 @@ public:
 
     virtual void SetActor(Actor * actor) override;
 
+    virtual void ExpandBounds(AABB& bounds) override;
+
+    virtual void AddToScene(Scene * scene) override;
+    virtual void RemoveFromScene(Scene * scene) override;
+
     virtual void OnUpdate(const Event& event);
-    virtual void OnRender(const Event& event);
+    virtual void OnRender(const Event& event) override;
 
     inline Model * GetModel() const { return _model.get(); };
 
@@ -75,8 +101,14 @@ public:
 
     virtual void SetActor(Actor * actor) override;
 
+    virtual void AddToScene(Scene * scene) override;
+    virtual void RemoveFromScene(Scene * scene) override;
+
     void OnUpdate(const Event& event);
 
+    // Follows the actor's interpolated transform, before the scene renders
+    void OnPreRender(const Event& event);
+
     inline Camera * GetCamera() const { return _camera.get(); };
 
 protected:
@@ -85,23 +117,44 @@ protected:
 
 }; // class CameraComponent
 
+// Parallel scripts get a lua_State of their own instead of sharing one, and
+// the scene calls their global OnUpdate(data) from a worker thread. They may
+// read anything, but only actor transforms can be changed, and those changes
+// are applied after every parallel script has finished.
 class ScriptComponent : public Component
 {
 public:
 
-    ScriptComponent(const std::string& filename, bool isTemplate = false);
+    ScriptComponent(const std::string& filename, bool isTemplate = false, bool isParallel = false);
     virtual ~ScriptComponent() = default;
 
     virtual std::unique_ptr<Component> Clone() override;
 
     virtual void SetActor(Actor * actor) override;
 
+    virtual void AddToScene(Scene * scene) override;
+    virtual void RemoveFromScene(Scene * scene) override;
+
+    inline bool IsParallel() const { return _isParallel; }
+
+    // Safe to call on any thread, for parallel scripts only
+    void OnParallelUpdate(const Event& event);
+
+    // Applies what OnParallelUpdate() buffered, on the main thread
+    void FlushCommands();
+
 protected:
 
     ScriptHost _scriptHost;
 
     std::string _filename;
 
+    bool _isParallel;
+
+    std::unique_ptr<LuaEventCallback> _onUpdate;
+
+    ScriptCommandBuffer _commands;
+
 }; // class ScriptComponent
 
 } // namespace dusk
@@ -0,0 +1,66 @@
+#ifndef DUSK_COMPONENT_POOL_HPP
+#define DUSK_COMPONENT_POOL_HPP
+
+#include <dusk/Config.hpp>
+
+#include <vector>
+
+namespace dusk {
+
+// Packed list of every live component of one type in a scene, so systems can
+// walk them in a tight loop instead of going through per-actor events.
+// Components remember their slot, which keeps removal constant time.
+template <typename T>
+class ComponentPool
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(ComponentPool);
+
+    static const size_t INVALID_INDEX = (size_t)-1;
+
+    ComponentPool() = default;
+    virtual ~ComponentPool() = default;
+
+    void Add(T * component)
+    {
+        if (INVALID_INDEX != component->GetPoolIndex())
+        {
+            return;
+        }
+
+        component->SetPoolIndex(_components.size());
+        _components.push_back(component);
+    }
+
+    void Remove(T * component)
+    {
+        size_t index = component->GetPoolIndex();
+        if (INVALID_INDEX == index)
+        {
+            return;
+        }
+
+        _components[index] = _components.back();
+        _components[index]->SetPoolIndex(index);
+        _components.pop_back();
+
+        component->SetPoolIndex(INVALID_INDEX);
+    }
+
+    size_t GetCount() const { return _components.size(); }
+
+    T * Get(size_t index) const { return _components[index]; }
+
+    typename std::vector<T *>::iterator begin() { return _components.begin(); }
+    typename std::vector<T *>::iterator end() { return _components.end(); }
+
+private:
+
+    std::vector<T *> _components;
+
+}; // class ComponentPool
+
+} // namespace dusk
+
+#endif // DUSK_COMPONENT_POOL_HPP
@@ -0,0 +1,125 @@
+#ifndef DUSK_EVENT_BUS_HPP
+#define DUSK_EVENT_BUS_HPP
+
+#include <dusk/Config.hpp>
+#include <dusk/Event.hpp>
+#include <dusk/MPSCQueue.hpp>
+
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+namespace dusk {
+
+class IEventDispatcher;
+
+// Lets worker threads send events to dispatchers on the main thread. Posting
+// never locks or allocates; events wait in a bounded ring until the app
+// drains the bus, and producers are held back while it is full. Targets must
+// outlive any events posted to them.
+class EventBus
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(EventBus);
+
+    // Largest payload that can be posted, stored inline in the ring
+    static const size_t PAYLOAD_SIZE = 64;
+
+    // Must be constructed on the thread that will call Dispatch()
+    explicit EventBus(size_t capacity = 4096);
+    virtual ~EventBus();
+
+    // Blocks while the bus is full, unless called from the main thread which
+    // would never get to drain it; those events are dropped with a warning
+    template <typename DataType>
+    void Post(IEventDispatcher * target, const EventID& eventId, const DataType& data)
+    {
+        if (IsConsumerThread())
+        {
+            if (!TryPost(target, eventId, data))
+            {
+                WarnDropped(eventId);
+            }
+            return;
+        }
+
+        _queue.Push(MakeFill(target, eventId, data));
+    }
+
+    void Post(IEventDispatcher * target, const EventID& eventId)
+    {
+        Post(target, eventId, EventData::Empty);
+    }
+
+    // Returns false instead of waiting when the bus is full
+    template <typename DataType>
+    bool TryPost(IEventDispatcher * target, const EventID& eventId, const DataType& data)
+    {
+        return _queue.TryPush(MakeFill(target, eventId, data));
+    }
+
+    // Main thread only, dispatches at most maxEvents in the order they were posted
+    size_t Dispatch(size_t maxEvents = (size_t)-1);
+
+    size_t GetDepth() const { return _queue.GetSize(); }
+    size_t GetCapacity() const { return _queue.GetCapacity(); }
+    size_t GetHighWater() const { return _queue.GetHighWater(); }
+    size_t GetStallCount() const { return _queue.GetStallCount(); }
+    size_t GetDroppedCount() const { return _queue.GetRejectedCount(); }
+
+private:
+
+    struct Message
+    {
+        IEventDispatcher * target;
+        EventID eventId;
+
+        // Points into payload, or at EventData::Empty
+        const EventData * data;
+        void (*destroy)(const EventData *);
+
+        typename std::aligned_storage<PAYLOAD_SIZE, alignof(std::max_align_t)>::type payload;
+    };
+
+    template <typename DataType>
+    static void Destroy(const EventData * data) { static_cast<const DataType *>(data)->~DataType(); }
+
+    template <typename DataType>
+    static auto MakeFill(IEventDispatcher * target, const EventID& eventId, const DataType& data)
+    {
+        static_assert(std::is_base_of<EventData, DataType>::value, "Event payloads must derive from EventData");
+        static_assert(sizeof(DataType) <= PAYLOAD_SIZE, "Event payload is too large for the EventBus");
+        static_assert(alignof(DataType) <= alignof(std::max_align_t), "Event payload is over-aligned");
+
+        return [target, eventId, &data](Message& message) {
+            message.target = target;
+            message.eventId = eventId;
+
+            if (&data == &EventData::Empty)
+            {
+                message.data = &EventData::Empty;
+                message.destroy = nullptr;
+            }
+            else
+            {
+                message.data = new (&message.payload) DataType(data);
+                message.destroy = &Destroy<DataType>;
+            }
+        };
+    }
+
+    bool IsConsumerThread() const { return std::this_thread::get_id() == _consumerThread; }
+
+    void WarnDropped(const EventID& eventId);
+
+    MPSCQueue<Message> _queue;
+
+    std::thread::id _consumerThread;
+
+}; // class EventBus
+
+} // namespace dusk
+
+#endif // DUSK_EVENT_BUS_HPP
@@ -29,6 +29,9 @@ public:
     // For MethodEventCallback
     inline virtual bool IsMethodOf(void * object) { return false; };
 
+    // Dispatchers drop listeners that can never run again instead of calling them
+    inline virtual bool IsExpired() const { return false; }
+
     inline virtual bool IsEqualTo(const IEventCallback& rhs) const { return false; }
 
 
@@ -94,28 +97,53 @@ class LuaEventCallback : public IEventCallback
 {
 public:
 
-    LuaEventCallback(lua_State * luaState, const std::string& funcName)
-        : _luaState(luaState)
-        , _funcName(funcName)
-    { }
+    // Takes the function, or the name of a global function, at the given
+    // stack index. envRef is the environment globals are looked up in, owned
+    // by its ScriptHost
+    LuaEventCallback(lua_State * luaState, int index, int envRef = LUA_NOREF);
+    virtual ~LuaEventCallback();
 
     virtual void Invoke(const Event& event) override;
 
+    // Once the state is closed or the script's host destroyed
+    virtual bool IsExpired() const override;
+
     inline virtual bool IsEqualTo(const IEventCallback& rhs) const override
     {
         if (const LuaEventCallback * convert = dynamic_cast<const LuaEventCallback *>(&rhs))
         {
-            return _luaState == convert->_luaState && _funcName == convert->_funcName;
+            return _luaState == convert->_luaState
+                && _envRef == convert->_envRef
+                && _funcName == convert->_funcName
+                && _funcPtr == convert->_funcPtr;
         }
         return false;
     }
 
 private:
 
+    // Looks a named function up the first time it's needed, since scripts
+    // can add listeners before defining them, and again after reloads
+    bool Resolve();
+
     lua_State * _luaState;
+    unsigned int _stateSerial;
+
     std::string _funcName;
+    const void * _funcPtr;
+    int _funcRef;
 
-}; // class MethodEventCallback
+    int _envRef;
+
+    // ScriptHost::GetReloadSerial() when the name was looked up
+    unsigned int _reloadSerial;
+
+    // Name in the profiler
+    std::string _label;
+
+    bool _reported;
+
+}; // class LuaEventCallback
 
 } // namespace dusk
 
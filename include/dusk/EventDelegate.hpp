@@ -0,0 +1,101 @@
+#ifndef DUSK_EVENT_DELEGATE_HPP
+#define DUSK_EVENT_DELEGATE_HPP
+
+#include <dusk/Config.hpp>
+#include <dusk/Event.hpp>
+
+#include <cstring>
+
+namespace dusk {
+
+class IEventCallback;
+
+// Type-erased event listener that stores its target inline, so building,
+// copying and comparing one never allocates and never needs RTTI.
+class EventDelegate
+{
+public:
+
+    // Large enough for any member function pointer, including the MSVC
+    // virtual inheritance ones
+    static const size_t STORAGE_SIZE = sizeof(void *) + 4 * sizeof(int);
+
+    EventDelegate()
+        : _object(nullptr)
+        , _invoke(nullptr)
+    {
+        memset(_storage, 0, sizeof(_storage));
+    }
+
+    static EventDelegate FromFunction(void (*function)(const Event&))
+    {
+        EventDelegate delegate;
+        memcpy(delegate._storage, &function, sizeof(function));
+        delegate._invoke = &FunctionStub;
+        return delegate;
+    }
+
+    template <typename ObjectType, typename MethodType>
+    static EventDelegate FromMethod(ObjectType * object, MethodType method)
+    {
+        static_assert(sizeof(MethodType) <= STORAGE_SIZE, "Method pointer is too large for EventDelegate");
+
+        EventDelegate delegate;
+        delegate._object = object;
+        memcpy(delegate._storage, &method, sizeof(method));
+        delegate._invoke = &MethodStub<ObjectType, MethodType>;
+        return delegate;
+    }
+
+    // Wraps a heap callback, ownership stays with the caller
+    static EventDelegate FromCallback(IEventCallback * callback);
+
+    // The wrapped heap callback, if this was made with FromCallback()
+    IEventCallback * GetCallback() const;
+
+    inline void operator()(const Event& event) const { _invoke(*this, event); }
+
+    inline bool IsBound() const { return nullptr != _invoke; }
+
+    inline friend bool operator==(const EventDelegate& lhs, const EventDelegate& rhs)
+    {
+        return lhs._invoke == rhs._invoke
+            && lhs._object == rhs._object
+            && 0 == memcmp(lhs._storage, rhs._storage, sizeof(lhs._storage));
+    }
+
+    inline friend bool operator!=(const EventDelegate& lhs, const EventDelegate& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+
+    typedef void (*InvokeStub)(const EventDelegate&, const Event&);
+
+    static void FunctionStub(const EventDelegate& delegate, const Event& event)
+    {
+        void (*function)(const Event&);
+        memcpy(&function, delegate._storage, sizeof(function));
+        (*function)(event);
+    }
+
+    template <typename ObjectType, typename MethodType>
+    static void MethodStub(const EventDelegate& delegate, const Event& event)
+    {
+        MethodType method;
+        memcpy(&method, delegate._storage, sizeof(method));
+        (static_cast<ObjectType *>(delegate._object)->*method)(event);
+    }
+
+    static void CallbackStub(const EventDelegate& delegate, const Event& event);
+
+    void * _object;
+    InvokeStub _invoke;
+    alignas(void *) unsigned char _storage[STORAGE_SIZE];
+
+}; // class EventDelegate
+
+} // namespace dusk
+
+#endif // DUSK_EVENT_DELEGATE_HPP
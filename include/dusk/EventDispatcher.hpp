@@ -4,11 +4,21 @@
 #include <dusk/Config.hpp>
 #include <dusk/Event.hpp>
 #include <dusk/EventCallbacks.hpp>
+#include <dusk/EventDelegate.hpp>
+#include <dusk/EventQueue.hpp>
 
-#include <unordered_map>
+#include <vector>
 
 namespace dusk {
 
+// Returned when adding a listener, removing through it skips the search.
+// The generation makes stale ids for reused slots harmless
+struct EventListenerID
+{
+    unsigned int slot = 0xFFFFFFFF;
+    unsigned int generation = 0;
+};
+
 class IEventDispatcher
 {
 public:
@@ -16,50 +26,138 @@ public:
     IEventDispatcher() = default;
     virtual ~IEventDispatcher()
     {
+        if (_queuedEvents > 0 && EventQueue::GetInst())
+        {
+            EventQueue::GetInst()->Cancel(this);
+        }
+
         RemoveAllEventListeners();
     }
 
-    void AddEventListener(const EventID& eventId, IEventCallback * callback);
+    // Takes ownership of the callback
+    EventListenerID AddEventListener(const EventID& eventId, IEventCallback * callback);
 
     void RemoveEventListener(const EventID& eventId, const IEventCallback * callback);
 
-    void AddEventListener(const EventID& eventId, void (*function)(const Event&))
+    EventListenerID AddEventListener(const EventID& eventId, const EventDelegate& delegate);
+
+    void RemoveEventListener(const EventID& eventId, const EventDelegate& delegate);
+
+    void RemoveEventListener(const EventListenerID& id);
+
+    EventListenerID AddEventListener(const EventID& eventId, void (*function)(const Event&))
     {
-        AddEventListener(eventId, new FunctionEventCallback(function));
+        return AddEventListener(eventId, EventDelegate::FromFunction(function));
     }
 
     void RemoveEventListener(const EventID& eventId, void (*function)(const Event&))
     {
-        FunctionEventCallback tmp(function);
-        RemoveEventListener(eventId, &tmp);
+        RemoveEventListener(eventId, EventDelegate::FromFunction(function));
     }
 
     template <typename ObjectType, typename MethodType>
-    void AddEventListener(const EventID& eventId, ObjectType * object, MethodType method)
+    EventListenerID AddEventListener(const EventID& eventId, ObjectType * object, MethodType method)
     {
-        AddEventListener(eventId, new MethodEventCallback<ObjectType, MethodType>(object, method));
+        return AddEventListener(eventId, EventDelegate::FromMethod(object, method));
     }
 
     template <typename ObjectType, typename MethodType>
     void RemoveEventListener(const EventID& eventId, ObjectType * object, MethodType method)
     {
-        MethodEventCallback<ObjectType, MethodType> tmp(object, method);
-        RemoveEventListener(eventId, &tmp);
+        RemoveEventListener(eventId, EventDelegate::FromMethod(object, method));
     }
 
+    // Listeners added during a dispatch are not called until the next one,
+    // listeners removed during a dispatch are skipped immediately
     void DispatchEvent(const Event& event);
 
+    // Queues the event to be dispatched when the app next drains the event
+    // queue. The payload is copied, so it can be a temporary
+    template <typename DataType>
+    void PostEvent(const EventID& eventId, const DataType& data, bool coalesce = false)
+    {
+        EventQueue::GetInst()->Post(this, eventId, data, coalesce);
+    }
+
+    void PostEvent(const EventID& eventId, bool coalesce = false)
+    {
+        EventQueue::GetInst()->Post(this, eventId, coalesce);
+    }
+
+    // Cheap enough to call before building an event nobody would receive
+    bool HasEventListeners(const EventID& eventId) const
+    {
+        for (const ListenerList& list : _listenerLists)
+        {
+            if (list.eventId == eventId)
+            {
+                return (list.liveCount > 0);
+            }
+        }
+        return false;
+    }
+
     void RemoveAllEventListeners();
     void RemoveAllEventListeners(const EventID& eventId);
 
     static void InitScripting();
+    static void BindScripting(lua_State * L);
+
     static int Script_AddEventListener(lua_State * L);
     static int Script_RemoveEventListener(lua_State * L);
+    static int Script_PostEvent(lua_State * L);
 
 private:
 
-    std::unordered_map<EventID, std::vector<IEventCallback *>> _eventListeners;
-    std::unordered_map<EventID, std::vector<IEventCallback *>> _deadEventListeners;
+    friend class EventQueue;
+
+    struct Listener
+    {
+        // Heap callbacks wrapped in the delegate are owned by us
+        EventDelegate delegate;
+
+        unsigned int slot;
+
+        bool dead;
+    };
+
+    // Where a listener currently lives, moved along when lists are compacted
+    struct Slot
+    {
+        unsigned int list;
+        unsigned int index;
+        unsigned int generation;
+    };
+
+    // Dispatchers rarely have more than a handful of event types, so a flat
+    // array beats hashing the id on every dispatch
+    struct ListenerList
+    {
+        EventID eventId;
+        std::vector<Listener> listeners;
+        size_t liveCount;
+        size_t deadCount;
+    };
+
+    size_t FindList(const EventID& eventId) const;
+
+    EventListenerID AddListener(const EventID& eventId, const EventDelegate& delegate);
+
+    void KillListener(ListenerList& list, Listener& listener);
+
+    // Drops dead listeners once no dispatch is walking the lists. Unless
+    // forced, lists are left alone until at least half their entries are dead
+    void Compact(bool force);
+
+    std::vector<ListenerList> _listenerLists;
+
+    std::vector<Slot> _slots;
+    std::vector<unsigned int> _freeSlots;
+
+    unsigned int _dispatchDepth = 0;
+
+    // Events posted to us that the queue hasn't delivered yet
+    unsigned int _queuedEvents = 0;
 
 }; // class IEventDispatcher
 
@@ -0,0 +1,98 @@
+#ifndef DUSK_EVENT_QUEUE_HPP
+#define DUSK_EVENT_QUEUE_HPP
+
+#include <dusk/Config.hpp>
+#include <dusk/Event.hpp>
+#include <dusk/FrameArena.hpp>
+
+#include <vector>
+
+namespace dusk {
+
+class IEventDispatcher;
+
+// Events posted here are delivered later, when the app drains the queue at
+// fixed points in the frame. Payloads are copied into a per-frame arena so
+// they outlive the caller without touching the heap.
+class EventQueue
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(EventQueue);
+
+    static EventQueue * GetInst() { return _Inst; }
+
+    EventQueue();
+    virtual ~EventQueue();
+
+    // A coalesced event replaces the payload of one already pending for the
+    // same target and id, keeping its place in the queue
+    template <typename DataType>
+    void Post(IEventDispatcher * target, const EventID& eventId, const DataType& data, bool coalesce = false)
+    {
+        static_assert(std::is_base_of<EventData, DataType>::value, "Event payloads must derive from EventData");
+
+        Frame& frame = _frames[_pending];
+        Push(target, eventId, frame.arena.New<DataType>(data), coalesce);
+    }
+
+    void Post(IEventDispatcher * target, const EventID& eventId, bool coalesce = false)
+    {
+        Push(target, eventId, &EventData::Empty, coalesce);
+    }
+
+    // Drops every pending event for a dispatcher that is going away
+    void Cancel(IEventDispatcher * target);
+
+    // Delivers everything posted before the call. Events posted by the
+    // listeners are held until the next Dispatch()
+    void Dispatch();
+
+    size_t GetPendingCount() const { return _frames[_pending].events.size(); }
+
+private:
+
+    static EventQueue * _Inst;
+
+    struct QueuedEvent
+    {
+        IEventDispatcher * target;
+        EventID eventId;
+        const EventData * data;
+        bool coalesce;
+    };
+
+    struct CoalesceSlot
+    {
+        IEventDispatcher * target;
+        EventID eventId;
+        size_t index;
+    };
+
+    struct Frame
+    {
+        FrameArena arena;
+        std::vector<QueuedEvent> events;
+
+        // Open addressing table of coalescable events by target and id
+        std::vector<CoalesceSlot> coalesce;
+        size_t coalesceCount = 0;
+    };
+
+    void Push(IEventDispatcher * target, const EventID& eventId, const EventData * data, bool coalesce);
+
+    CoalesceSlot * FindCoalesceSlot(Frame& frame, IEventDispatcher * target, const EventID& eventId);
+
+    void GrowCoalesceTable(Frame& frame);
+
+    // Posts go into one frame while the other is being delivered
+    Frame _frames[2];
+    unsigned int _pending;
+
+    bool _dispatching;
+
+}; // class EventQueue
+
+} // namespace dusk
+
+#endif // DUSK_EVENT_QUEUE_HPP
@@ -0,0 +1,92 @@
+#ifndef DUSK_FILE_WATCHER_HPP
+#define DUSK_FILE_WATCHER_HPP
+
+#include <dusk/Config.hpp>
+#include <dusk/Platform.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dusk {
+
+// Calls back when watched files change on disk, so assets can reload in
+// place. On Linux this uses inotify on the parent directories, which also
+// catches editors that save by renaming over the file. Elsewhere the
+// modification times are polled every POLL_INTERVAL seconds.
+class FileWatcher
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(FileWatcher);
+
+    typedef unsigned int WatchID;
+
+    static const WatchID INVALID_WATCH = 0;
+
+    static const double POLL_INTERVAL;
+
+    typedef std::function<void(const std::string&)> Callback;
+
+    FileWatcher();
+    virtual ~FileWatcher();
+
+    // Off until enabled, watches can still be added in the meantime
+    void SetEnabled(bool enabled);
+    inline bool IsEnabled() const { return _enabled; }
+
+    // Several watches on one file are called in the order they were added
+    WatchID Watch(const std::string& filename, Callback callback);
+    void Unwatch(WatchID id);
+
+    // Calls back for every file changed since the last call, at most once
+    // each. Callbacks may add and remove watches
+    void Poll();
+
+private:
+
+    struct Watcher
+    {
+        WatchID id;
+        std::string filename;
+        Callback callback;
+        time_t mtime;
+    };
+
+    static time_t GetModifiedTime(const std::string& filename);
+
+    void CollectChanges();
+
+    bool _enabled;
+
+    WatchID _nextId;
+
+    std::vector<Watcher> _watchers;
+
+    // Reused between polls
+    std::vector<std::string> _changed;
+    std::vector<WatchID> _pending;
+
+#if defined(DUSK_OS_LINUX)
+
+    void AddDirectory(const std::string& filename);
+
+    int _inotify;
+
+    // Watch descriptor to directory
+    std::unordered_map<int, std::string> _directories;
+
+#else
+
+    std::chrono::steady_clock::time_point _lastPoll;
+
+#endif
+
+}; // class FileWatcher
+
+} // namespace dusk
+
+#endif // DUSK_FILE_WATCHER_HPP
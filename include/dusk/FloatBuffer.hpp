@@ -0,0 +1,50 @@
+#ifndef DUSK_FLOAT_BUFFER_HPP
+#define DUSK_FLOAT_BUFFER_HPP
+
+#include <dusk/Config.hpp>
+
+#include <vector>
+
+namespace dusk {
+
+// Flat array of floats owned by Lua, so scripts can hand thousands of values
+// to the engine in one call instead of one call per value. Indices are
+// zero based here and one based in Lua.
+class FloatBuffer
+{
+public:
+
+    explicit FloatBuffer(size_t size = 0)
+        : _data(size, 0.0f)
+    { }
+
+    FloatBuffer(const FloatBuffer&) = default;
+    virtual ~FloatBuffer() = default;
+    FloatBuffer& operator=(const FloatBuffer&) = default;
+
+    inline float Get(size_t index) const { return _data[index]; }
+    inline void Set(size_t index, float value) { _data[index] = value; }
+
+    inline void Resize(size_t size) { _data.resize(size, 0.0f); }
+    inline size_t GetSize() const { return _data.size(); }
+
+    inline float * GetData() { return _data.data(); }
+    inline const float * GetData() const { return _data.data(); }
+
+    static void InitScripting();
+    static void BindScripting(lua_State * L);
+
+    static int Script_Get(lua_State * L);
+    static int Script_Set(lua_State * L);
+    static int Script_GetVec3(lua_State * L);
+    static int Script_SetVec3(lua_State * L);
+
+private:
+
+    std::vector<float> _data;
+
+}; // class FloatBuffer
+
+} // namespace dusk
+
+#endif // DUSK_FLOAT_BUFFER_HPP
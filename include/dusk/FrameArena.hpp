@@ -0,0 +1,85 @@
+#ifndef DUSK_FRAME_ARENA_HPP
+#define DUSK_FRAME_ARENA_HPP
+
+#include <dusk/Config.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dusk {
+
+// Bump allocator for data that only lives until the next Reset(). Once the
+// arena has grown to fit a typical frame it never touches the heap again.
+class FrameArena
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(FrameArena);
+
+    explicit FrameArena(size_t blockSize = 64 * 1024);
+    virtual ~FrameArena();
+
+    void * Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    // Destructors of objects created with New() are run by Reset()
+    template <typename T, typename... Args>
+    T * New(Args&&... args)
+    {
+        T * object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            Destructor * dtor = new (Allocate(sizeof(Destructor), alignof(Destructor))) Destructor();
+            dtor->object = object;
+            dtor->destroy = &Destroy<T>;
+            dtor->next = _destructors;
+            _destructors = dtor;
+        }
+
+        return object;
+    }
+
+    void Reset();
+
+    size_t GetBytesUsed() const { return _used; }
+    size_t GetCapacity() const { return _capacity; }
+
+private:
+
+    struct Destructor
+    {
+        void * object;
+        void (*destroy)(void *);
+        Destructor * next;
+    };
+
+    template <typename T>
+    static void Destroy(void * object) { static_cast<T *>(object)->~T(); }
+
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    void AddBlock(size_t minSize);
+
+    size_t _blockSize;
+
+    std::vector<Block> _blocks;
+    size_t _offset;
+
+    size_t _used;
+    size_t _capacity;
+
+    Destructor * _destructors;
+
+}; // class FrameArena
+
+} // namespace dusk
+
+#endif // DUSK_FRAME_ARENA_HPP
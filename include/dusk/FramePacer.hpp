@@ -0,0 +1,106 @@
+#ifndef DUSK_FRAME_PACER_HPP
+#define DUSK_FRAME_PACER_HPP
+
+#include <dusk/Config.hpp>
+
+#include <chrono>
+#include <string>
+
+namespace dusk {
+
+// Decides when the next frame starts and measures how long frames take.
+// VSYNC lets the driver block in glfwSwapBuffers(), LIMITED sleeps until
+// close to the deadline and spins the rest to hit it precisely, UNCAPPED
+// runs as fast as it can.
+class FramePacer
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(FramePacer);
+
+    enum class Mode
+    {
+        VSYNC,
+        LIMITED,
+        UNCAPPED,
+    };
+
+    // Used instead of the target while idle, whatever the mode
+    static const double IDLE_FPS;
+
+    // How often GetCurrentFPS() is recalculated, in seconds
+    static const double FPS_INTERVAL;
+
+    FramePacer();
+    virtual ~FramePacer() = default;
+
+    // "VSync", "Limited" or "Uncapped", returns false for anything else
+    static bool ParseMode(const std::string& name, Mode& mode);
+
+    // Sets the swap interval if there's a current GL context, call again
+    // once one is created
+    void SetMode(Mode mode);
+    inline Mode GetMode() const { return _mode; }
+
+    // Only used by LIMITED
+    void SetTargetFPS(double fps);
+    inline double GetTargetFPS() const { return _targetFPS; }
+
+    // Nothing to show, e.g. the window is minimized. Frames are slowed to
+    // IDLE_FPS so we don't spin when vsync has nothing to wait on
+    inline void SetIdle(bool idle) { _idle = idle; }
+    inline bool IsIdle() const { return _idle; }
+
+    // Restarts timing, so the first frame doesn't include loading
+    void Reset();
+
+    // Call at the start of every frame, returns seconds since the last one
+    double BeginFrame();
+
+    // Call at the end of every frame, waits until the next one is due
+    void EndFrame();
+
+    // Milliseconds
+    inline double GetFrameTime() const { return _frameTime; }
+    inline double GetWaitTime() const { return _waitTime; }
+
+    inline double GetCurrentFPS() const { return _currentFPS; }
+
+protected:
+
+    // Only blocks for the part of the wait that's safe to sleep through
+    virtual void SleepFor(std::chrono::duration<double, std::milli> duration);
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    void WaitUntil(Clock::time_point deadline, Clock::duration period);
+
+    Mode _mode;
+
+    double _targetFPS;
+
+    bool _idle;
+
+    Clock::time_point _frameStart;
+    Clock::time_point _nextFrame;
+
+    double _frameTime;
+    double _waitTime;
+
+    // How far past the requested time a short sleep has been seen to wake,
+    // we stop sleeping this far from the deadline and spin instead. Kept
+    // below a quarter of the period, so one bad wakeup can't stop us
+    // sleeping for good
+    double _sleepSlack;
+
+    Clock::time_point _fpsStart;
+    unsigned int _fpsFrames;
+    double _currentFPS;
+
+}; // class FramePacer
+
+} // namespace dusk
+
+#endif // DUSK_FRAME_PACER_HPP
@@ -30,7 +30,8 @@ namespace dusk {
         const short BG_DEFAULT = 49;
 
         va_list valist;
-        static char buffer[MAX_LOG_LINE_LEN];
+        // Assets are loaded from worker threads, which log too
+        static thread_local char buffer[MAX_LOG_LINE_LEN];
 
         ImVec4 imColor;
         short fgColor, bgColor;
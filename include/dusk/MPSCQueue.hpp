@@ -0,0 +1,181 @@
+#ifndef DUSK_MPSC_QUEUE_HPP
+#define DUSK_MPSC_QUEUE_HPP
+
+#include <dusk/Config.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace dusk {
+
+// Bounded lock-free queue for many producer threads and one consumer, based
+// on Dmitry Vyukov's sequenced ring. Values stay in their cell; producers fill
+// them in place and the consumer reads them in place, so nothing is moved or
+// allocated after construction.
+template <typename T>
+class MPSCQueue
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(MPSCQueue);
+
+    // Capacity is rounded up to a power of two
+    explicit MPSCQueue(size_t capacity = 1024)
+        : _cells(RoundUp(capacity))
+        , _mask(_cells.size() - 1)
+    {
+        for (size_t i = 0; i < _cells.size(); ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    virtual ~MPSCQueue() = default;
+
+    // Calls fill(T&) on a free cell, returns false if the queue is full
+    template <typename Func>
+    bool TryPush(Func fill)
+    {
+        if (!Enqueue(fill))
+        {
+            ++_rejectedCount;
+            return false;
+        }
+        return true;
+    }
+
+    // Waits for the consumer to make room if the queue is full
+    template <typename Func>
+    void Push(Func fill)
+    {
+        if (Enqueue(fill))
+        {
+            return;
+        }
+
+        ++_stallCount;
+        while (!Enqueue(fill))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Consumer only, calls consume(T&) on the oldest value
+    template <typename Func>
+    bool TryPop(Func consume)
+    {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = _cells[pos & _mask];
+
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+        {
+            return false;
+        }
+
+        consume(cell.value);
+
+        cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+        _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    // Approximate while producers are running
+    size_t GetSize() const
+    {
+        size_t enqueued = _enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = _dequeuePos.load(std::memory_order_relaxed);
+        return (enqueued > dequeued ? enqueued - dequeued : 0);
+    }
+
+    size_t GetCapacity() const { return _cells.size(); }
+
+    // Deepest the queue has been since construction
+    size_t GetHighWater() const { return _highWater.load(std::memory_order_relaxed); }
+
+    // Pushes that had to wait, and TryPushes that gave up, because it was full
+    size_t GetStallCount() const { return _stallCount.load(std::memory_order_relaxed); }
+    size_t GetRejectedCount() const { return _rejectedCount.load(std::memory_order_relaxed); }
+
+private:
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t RoundUp(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    template <typename Func>
+    bool Enqueue(Func& fill)
+    {
+        Cell * cell;
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &_cells[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (0 == diff)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(cell->value);
+
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        size_t depth = pos + 1 - _dequeuePos.load(std::memory_order_relaxed);
+        size_t highWater = _highWater.load(std::memory_order_relaxed);
+        while (depth > highWater && !_highWater.compare_exchange_weak(highWater, depth, std::memory_order_relaxed))
+        { }
+
+        return true;
+    }
+
+    std::vector<Cell> _cells;
+    size_t _mask;
+
+    // Keep producers and the consumer off each other's cache lines, padded
+    // rather than aligned so the queue can be allocated with plain new
+    char _pad0[64];
+    std::atomic<size_t> _enqueuePos { 0 };
+    char _pad1[64];
+    std::atomic<size_t> _dequeuePos { 0 };
+    char _pad2[64];
+
+    std::atomic<size_t> _highWater { 0 };
+    std::atomic<size_t> _stallCount { 0 };
+    std::atomic<size_t> _rejectedCount { 0 };
+
+}; // class MPSCQueue
+
+} // namespace dusk
+
+#endif // DUSK_MPSC_QUEUE_HPP
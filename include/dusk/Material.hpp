@@ -61,6 +61,14 @@ public:
 
     void Bind(Shader * shader);
 
+    const MaterialData& GetShaderData() const { return _shaderData; }
+
+    static void BindSamplers(Shader * shader);
+
+    Texture * GetMap(TextureID id) const;
+
+    unsigned int GetSortId() const { return _sortId; }
+
     // TODO: Fix
     std::string GetId();
 
@@ -76,6 +84,10 @@ private:
              const std::string& specularMap,
              const std::string& bumpMap);
 
+    static unsigned int _NextSortId;
+
+    unsigned int _sortId;
+
     MaterialData _shaderData;
 
     glm::vec4 _ambient;
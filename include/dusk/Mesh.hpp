@@ -6,11 +6,26 @@
 #include <dusk/EventDispatcher.hpp>
 #include <dusk/Shader.hpp>
 #include <dusk/Material.hpp>
+#include <dusk/Asset.hpp>
+#include <dusk/RenderQueue.hpp>
+#include <dusk/Bounds.hpp>
 #include <memory>
 #include <sstream>
 
 namespace dusk {
 
+struct Vertex
+{
+    glm::vec3 position = glm::vec3(0);
+    glm::vec3 normal   = glm::vec3(0);
+    glm::vec2 texcoord = glm::vec2(0);
+
+    inline bool operator==(const Vertex& rhs) const
+    {
+        return position == rhs.position && normal == rhs.normal && texcoord == rhs.texcoord;
+    }
+};
+
 class Mesh
     : public std::enable_shared_from_this<Mesh>
     , public IEventDispatcher
@@ -22,6 +37,9 @@ public:
         VERTS = 0,
         NORMS = 1,
         TXCDS = 2,
+
+        // Per-instance model matrix, one column each in 4-7
+        INSTANCE = 4,
     };
 
     DISALLOW_COPY_AND_ASSIGN(Mesh);
@@ -31,7 +49,11 @@ public:
     static std::shared_ptr<Mesh> Parse(nlohmann::json & data);
 
     virtual void Update();
-    virtual void Render(Shader * shader);
+    virtual void Render(RenderQueue * queue, Shader * shader, TransformData * transform);
+
+    // Object space, invalid until the first render group is added
+    const AABB& GetBounds() const { return _bounds; }
+    const BoundingSphere& GetBoundingSphere() const { return _boundingSphere; }
 
 protected:
 
@@ -55,38 +77,67 @@ protected:
                         const float * verts,
                         const float * norms,
                         const float * txcds);
+
+    bool AddRenderGroup(std::shared_ptr<Material> material,
+                        GLenum drawMode,
+                        const std::vector<Vertex>& vertices,
+                        const std::vector<GLuint>& indices);
+
 private:
 
     struct RenderGroup
     {
         std::shared_ptr<Material> material;
 
-		GLsizei vertCount;
+        GLsizei vertCount;
+        GLsizei indexCount;
 
         GLenum drawMode;
+        GLenum indexType;
         GLuint glVAO;
-        GLuint glVBOs[3];
+        GLuint glVBO;
+        GLuint glIBO;
     };
 
     std::vector<RenderGroup> _renderGroups;
 
+    AABB _bounds;
+    BoundingSphere _boundingSphere;
+
 }; // class Mesh
 
-class FileMesh : public Mesh
+class FileMesh
+    : public Mesh
+    , public ILoadable
 {
 public:
 
     static std::shared_ptr<FileMesh>
     Create(const std::string& filename);
 
+    virtual bool Load() override;
+    virtual bool Upload() override;
+
 protected:
 
     FileMesh(const std::string& filename);
 
 private:
 
+    // Decoded on a worker thread, turned into render groups by Upload()
+    struct PendingGroup
+    {
+        bool hasMaterial;
+        tinyobj::material_t material;
+
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+    };
+
     std::string _filename;
 
+    std::vector<PendingGroup> _pendingGroups;
+
     bool LoadOBJ(const std::string& filename);
     //bool LoadDMF(const std::string& filename);
 
@@ -4,19 +4,12 @@
 #include <dusk/Config.hpp>
 
 #include <dusk/Mesh.hpp>
+#include <dusk/TransformPool.hpp>
 #include <memory>
 
 namespace dusk
 {
 
-struct TransformData
-{
-    alignas(64) glm::mat4 model = glm::mat4(1);
-    alignas(64) glm::mat4 view  = glm::mat4(1);
-    alignas(64) glm::mat4 proj  = glm::mat4(1);
-    alignas(64) glm::mat4 mvp   = glm::mat4(1);
-};
-
 class Model
 {
 public:
@@ -33,19 +26,27 @@ public:
 
     void SetBaseTransform(const glm::mat4& baseTransform);
 
+    // Usually the owning actor's transform
+    void SetParentTransform(unsigned int parent);
+
     void SetPosition(const glm::vec3& pos);
-    glm::vec3 GetPosition() const { return _position; }
+    glm::vec3 GetPosition() const { return _transformPool->GetPosition(_transformHandle); }
 
     void SetRotation(const glm::vec3& rot);
-    glm::vec3 GetRotation() const { return _rotation; }
+    glm::vec3 GetRotation() const { return _transformPool->GetRotation(_transformHandle); }
 
     void SetScale(const glm::vec3& scale);
-    glm::vec3 GetScale() const { return _scale; }
+    glm::vec3 GetScale() const { return _transformPool->GetScale(_transformHandle); }
 
-    glm::mat4 GetTransform();
+    glm::mat4 GetTransform() const { return _transformPool->GetWorld(_transformHandle); }
 
     virtual void Update();
-    virtual void Render();
+    virtual void Render(RenderQueue * queue);
+
+    void UpdateBounds();
+
+    // World space, refreshed by UpdateBounds()
+    const AABB& GetWorldBounds() const { return _worldBounds; }
 
     /*
     static void InitScripting();
@@ -64,11 +65,14 @@ private:
 
     TransformData _shaderData;
 
-    glm::mat4 _baseTransform;
-    glm::mat4 _transform;
-    glm::vec3 _position;
-    glm::vec3 _rotation;
-    glm::vec3 _scale;
+    // Versions _shaderData was last built from
+    unsigned int _transformVersion;
+    unsigned int _cameraVersion;
+
+    AABB _worldBounds;
+
+    TransformPool * _transformPool;
+    unsigned int _transformHandle;
 
     std::vector<std::shared_ptr<Mesh>> _meshes;
 
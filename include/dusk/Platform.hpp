@@ -7,4 +7,8 @@
 #define DUSK_OS_WINDOWS
 #endif
 
+#ifdef __linux__
+#define DUSK_OS_LINUX
+#endif
+
 #endif // DUSK_PLATFORM_HPP
\ No newline at end of file
@@ -0,0 +1,139 @@
+#ifndef DUSK_RENDER_QUEUE_HPP
+#define DUSK_RENDER_QUEUE_HPP
+
+#include <dusk/Config.hpp>
+
+#include <dusk/UniformRing.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace dusk {
+
+class Shader;
+class Material;
+
+struct TransformData
+{
+    alignas(64) glm::mat4 model = glm::mat4(1);
+    alignas(64) glm::mat4 view  = glm::mat4(1);
+    alignas(64) glm::mat4 proj  = glm::mat4(1);
+    alignas(64) glm::mat4 mvp   = glm::mat4(1);
+};
+
+struct DrawItem
+{
+    Shader * shader;
+    Material * material;
+
+    GLuint glVAO;
+    GLenum drawMode;
+    GLsizei indexCount;
+    GLenum indexType;
+
+    TransformData * transform;
+};
+
+struct RenderStats
+{
+    unsigned int items;
+    unsigned int drawCalls;
+    unsigned int instancedDrawCalls;
+
+    unsigned int shaderBinds;
+    unsigned int materialBinds;
+    unsigned int textureBinds;
+    unsigned int vaoBinds;
+    unsigned int transformBinds;
+
+    size_t uniformBytes;
+
+    // Binds that an unsorted submission would have made
+    unsigned int skippedBinds;
+};
+
+class RenderQueue
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(RenderQueue);
+
+    RenderQueue();
+    virtual ~RenderQueue();
+
+    void Clear();
+
+    void Add(const DrawItem& item);
+
+    // Sort by shader, material, texture, VAO, then front-to-back depth
+    void Sort();
+
+    void Submit();
+
+    void SetDepthRange(float znear, float zfar);
+
+    // Bumps the camera version only if either matrix actually changed
+    void SetCamera(const glm::mat4& view, const glm::mat4& proj);
+
+    const glm::mat4& GetView() const { return _view; }
+    const glm::mat4& GetProjection() const { return _proj; }
+    const glm::mat4& GetViewProjection() const { return _viewProj; }
+    unsigned int GetCameraVersion() const { return _cameraVersion; }
+
+    const RenderStats& GetStats() const { return _stats; }
+
+private:
+
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+
+        GLintptr transformOffset;
+        GLintptr materialOffset;
+
+        inline bool operator<(const SortEntry& rhs) const { return key < rhs.key; }
+    };
+
+    uint64_t MakeKey(const DrawItem& item) const;
+
+    // Consecutive items that can share one instanced draw
+    struct Batch
+    {
+        uint32_t first;
+        uint32_t count;
+
+        bool instanced;
+        GLintptr instanceOffset;
+    };
+
+    static bool CanBatch(const DrawItem& lhs, const DrawItem& rhs);
+
+    bool WriteUniforms();
+    void WriteInstances();
+
+    std::vector<DrawItem> _items;
+    std::vector<SortEntry> _entries;
+    std::vector<Batch> _batches;
+
+    std::vector<glm::mat4> _instanceData;
+    GLuint _glInstanceVBO;
+    size_t _instanceCapacity;
+
+    UniformRing _uniformRing;
+
+    float _znear;
+    float _zfar;
+
+    glm::mat4 _view;
+    glm::mat4 _proj;
+    glm::mat4 _viewProj;
+    unsigned int _cameraVersion;
+
+    RenderStats _stats;
+
+}; // class RenderQueue
+
+} // namespace dusk
+
+#endif // DUSK_RENDER_QUEUE_HPP
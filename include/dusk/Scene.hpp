@@ -6,6 +6,9 @@
 #include <dusk/EventDispatcher.hpp>
 #include <dusk/Actor.hpp>
 #include <dusk/Camera.hpp>
+#include <dusk/RenderQueue.hpp>
+#include <dusk/BVH.hpp>
+#include <dusk/ComponentPool.hpp>
 #include <string>
 #include <vector>
 #include <memory>
@@ -44,6 +47,23 @@ public:
     void SetCurrentCamera(Camera * camera) { _currentCamera = camera; }
     Camera * GetCurrentCamera() const { return _currentCamera; };
 
+    RenderQueue * GetRenderQueue() { return &_renderQueue; }
+
+    ComponentPool<ModelComponent>& GetModelComponents() { return _modelComponents; }
+    ComponentPool<CameraComponent>& GetCameraComponents() { return _cameraComponents; }
+    ComponentPool<ScriptComponent>& GetParallelScripts() { return _parallelScripts; }
+
+    unsigned int GetVisibleCount() const { return _visibleCount; }
+    unsigned int GetCulledCount() const { return _culledCount; }
+
+    // Called by actors when their world bounds change
+    void UpdateActorBounds(Actor * actor);
+    void RemoveActorBounds(Actor * actor);
+
+    void QueryRadius(const glm::vec3& center, float radius, std::vector<Actor *>& actors) const;
+
+    Actor * Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, float * hitDist = nullptr) const;
+
     void Start();
     void Stop();
 
@@ -51,7 +71,7 @@ public:
     void Render(const Event& event);
 
     static void InitScripting();
-    static int Script_GetActorByName(lua_State * L);
+    static void BindScripting(lua_State * L);
 
 private:
 
@@ -59,6 +79,27 @@ private:
 
     ScriptHost _scriptHost;
 
+    RenderQueue _renderQueue;
+
+    BVH _bvh;
+
+    // Updated by the scene each frame instead of through actor events
+    ComponentPool<ModelComponent> _modelComponents;
+    ComponentPool<CameraComponent> _cameraComponents;
+    ComponentPool<ScriptComponent> _parallelScripts;
+
+    // Actors without bounds yet, always rendered
+    std::vector<Actor *> _unboundedActors;
+
+    std::vector<void *> _visibleActors;
+
+    unsigned int _visibleCount;
+    unsigned int _culledCount;
+
+    void CullActors();
+
+    void UpdateParallelScripts(const Event& event);
+
     std::vector<std::unique_ptr<Camera>> _cameras;
     std::vector<std::unique_ptr<Actor>> _actors;
 
@@ -0,0 +1,73 @@
+#ifndef DUSK_SCRIPT_CACHE_HPP
+#define DUSK_SCRIPT_CACHE_HPP
+
+#include <dusk/Config.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dusk {
+
+// Keeps the lua_dump() output of every script file we've compiled, keyed by
+// path and checked against a hash of the file's contents, so each version of
+// a file is only parsed once per run. With a directory set, the bytecode is
+// also written to disk and reused on the next run.
+//
+// Parallel scripts call require on worker threads, so everything but
+// SetDirectory() is safe to call from any thread.
+class ScriptCache
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(ScriptCache);
+
+    ScriptCache();
+    virtual ~ScriptCache();
+
+    // Directory for cached bytecode, which must already exist. Empty disables
+    // the disk cache
+    void SetDirectory(const std::string& directory);
+    inline const std::string& GetDirectory() const { return _directory; }
+
+    // Drop-in replacement for luaL_loadfile()
+    int LoadFile(lua_State * L, const std::string& filename);
+
+    void Clear();
+
+    unsigned int GetHitCount() const;
+    unsigned int GetMissCount() const;
+
+private:
+
+    struct Entry
+    {
+        uint64_t hash;
+        long long size;
+        std::string bytecode;
+    };
+
+    std::string GetCachePath(const std::string& filename) const;
+
+    bool ReadEntry(const std::string& filename, Entry& entry) const;
+    void WriteEntry(const std::string& filename, const Entry& entry) const;
+
+    static int Writer(lua_State * L, const void * data, size_t size, void * userdata);
+
+    // Guards the entries, the counters and the disk cache. Held while
+    // compiling, so two threads never compile or write the same file
+    mutable std::mutex _mutex;
+
+    std::unordered_map<std::string, Entry> _entries;
+
+    std::string _directory;
+
+    unsigned int _hitCount;
+    unsigned int _missCount;
+
+}; // class ScriptCache
+
+} // namespace dusk
+
+#endif // DUSK_SCRIPT_CACHE_HPP
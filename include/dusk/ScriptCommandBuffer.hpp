@@ -0,0 +1,80 @@
+#ifndef DUSK_SCRIPT_COMMAND_BUFFER_HPP
+#define DUSK_SCRIPT_COMMAND_BUFFER_HPP
+
+#include <dusk/Config.hpp>
+
+#include <vector>
+
+namespace dusk {
+
+class TransformPool;
+
+// Engine changes made by a script running on a worker thread. Bindings push
+// here instead of touching the engine, and the main thread applies every
+// buffer in a fixed order once the workers are done.
+class ScriptCommandBuffer
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(ScriptCommandBuffer);
+
+    enum class Type : unsigned char
+    {
+        SET_POSITION,
+        SET_ROTATION,
+        SET_SCALE,
+    };
+
+    ScriptCommandBuffer() = default;
+    virtual ~ScriptCommandBuffer() = default;
+
+    // The buffer for scripts running on this thread, null when they can touch
+    // the engine directly
+    static ScriptCommandBuffer * GetCurrent() { return _Current; }
+    static void SetCurrent(ScriptCommandBuffer * buffer) { _Current = buffer; }
+
+    // Raises a Lua error when a parallel script calls a binding that changes
+    // the engine and has no command to queue instead
+    static void CheckMainThread(lua_State * L, const char * name)
+    {
+        if (_Current)
+        {
+            luaL_error(L, "%s can't be called from a parallel script", name);
+        }
+    }
+
+    // Wraps a setter for binding, with CheckMainThread() before the call
+    template <typename T, typename... Args>
+    static auto MainThreadOnly(void (T::*func)(Args...), const char * name)
+    {
+        return [func, name](T& self, Args... args, sol::this_state L) {
+            CheckMainThread(L, name);
+            (self.*func)(args...);
+        };
+    }
+
+    void Push(Type type, unsigned int handle, const glm::vec3& value);
+
+    // Applies the commands in the order they were pushed, then clears them
+    void Flush(TransformPool * transformPool);
+
+    inline size_t GetCount() const { return _commands.size(); }
+
+private:
+
+    struct Command
+    {
+        Type type;
+        unsigned int handle;
+        glm::vec3 value;
+    };
+
+    std::vector<Command> _commands;
+
+    static thread_local ScriptCommandBuffer * _Current;
+
+}; // class ScriptCommandBuffer
+
+} // namespace dusk
+
+#endif // DUSK_SCRIPT_COMMAND_BUFFER_HPP
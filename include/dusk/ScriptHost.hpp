@@ -2,19 +2,28 @@
 #define DUSK_SCRIPT_HOST_HPP
 
 #include <dusk/Config.hpp>
+#include <dusk/ScriptCache.hpp>
+#include <dusk/FileWatcher.hpp>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 
 namespace dusk {
 
+class ScriptScheduler;
+class ScriptProfiler;
+
 class ScriptHost
 {
 public:
 
     DISALLOW_COPY_AND_ASSIGN(ScriptHost);
 
-    ScriptHost();
+    // Shared hosts run in one lua_State owned by all of them, each with its
+    // own environment table that falls back to the shared globals. Private
+    // hosts get a whole state to themselves.
+    explicit ScriptHost(bool shared = false);
     virtual ~ScriptHost();
 
     bool Load();
@@ -23,19 +32,163 @@ public:
     bool RunFile(const std::string& filename);
     bool RunString(const std::string& code);
 
+    // Runs the file again in the same environment, so globals it doesn't
+    // reset survive. A global OnUnload() is called first, to undo anything
+    // that running twice would duplicate. Called when the file changes
+    bool ReloadFile(const std::string& filename);
+
     lua_State * GetLuaState() const { return _luaState; }
 
+    inline bool IsShared() const { return _shared; }
+
+    // Sets a global visible to this host's scripts only
+    void SetGlobal(const std::string& name, lua_Integer value);
+
+    // Time and Lua heap spent setting up this host and running its scripts
+    double GetLoadTime() const { return _loadTime; }
+    size_t GetMemoryUsage() const { return _memoryUsage; }
+
     static bool AddFunction(const std::string& funcName, lua_CFunction function);
 
+    // Called for every state, current and future, to register usertypes.
+    // The global Dusk table already exists when bindings run
+    typedef void (*BindFunction)(lua_State * L);
+    static bool AddBinding(BindFunction bind);
+
+    // Compiled scripts shared by every host, used by RunFile() and require
+    static ScriptCache& GetCache() { return _Cache; }
+
+    // Coroutines started with Dusk.StartCoroutine, updated by the app
+    static ScriptScheduler& GetScheduler();
+
+    static ScriptProfiler& GetProfiler();
+
+    // Id of the environment of the script that is running right now on this
+    // thread, LUA_NOREF for private hosts. Ids are never reused, so anything
+    // holding one can tell when its host is gone
+    static int GetCurrentEnv() { return _CurrentEnv; }
+    static void SetCurrentEnv(int envRef) { _CurrentEnv = envRef; }
+
+    static bool IsEnvAlive(int envRef) { return LUA_NOREF == envRef || _LiveEnvs.count(envRef) > 0; }
+
+    // Pushes a global as seen by the running script
+    static void PushGlobal(lua_State * L, const char * name);
+
+    // lua_pcall() that logs errors with a traceback instead of leaving them
+    // on the stack
+    static bool Call(lua_State * L, int argCount, int resultCount);
+
+    // Non-zero while the state is open, never reused for another state
+    static unsigned int GetStateSerial(lua_State * L);
+
+    // Changes whenever a script is reloaded, functions looked up by name
+    // before that may be stale
+    static unsigned int GetReloadSerial() { return _ReloadSerial; }
+
+    // The collector only runs from here, in steps, until the budget for the
+    // frame is spent. Each state gets an even share, and the one that goes
+    // first changes every frame. Call once per frame when there's idle time
+    static void StepGC();
+
+    static void SetGCBudget(double budget) { _GCBudget = budget; }
+    static double GetGCBudget() { return _GCBudget; }
+
+    // Milliseconds spent in StepGC() last frame
+    static double GetGCTime() { return _GCTime; }
+
+    static unsigned int GetGCCycleCount() { return _GCCycleCount; }
+
+    // Bytes used by every open state
+    static size_t GetTotalMemory();
+
+    static std::vector<lua_State *> GetStates();
+
+    // Label for a function in profiles, "name (source:line)"
+    static std::string DescribeFunction(lua_State * L, int index, const char * name = nullptr);
+
 private:
 
+    static size_t GetLuaMemory(lua_State * L);
+
+    static void BindCoreTypes(lua_State * L);
+
+    // Pushes the environment table, or nil once its host is gone
+    static void PushEnv(lua_State * L, int envRef);
+
+    static void InstallSearcher(lua_State * L);
+    static int Script_Searcher(lua_State * L);
+    static int Script_Traceback(lua_State * L);
+
+    bool Run(const std::string& name, int loadStatus);
+
     static std::vector<ScriptHost *> _ScriptHosts;
     static std::unordered_map<std::string, lua_CFunction> _Functions;
+    static std::vector<BindFunction> _Bindings;
+
+    static lua_State * _SharedState;
+    static unsigned int _SharedCount;
+
+    static thread_local int _CurrentEnv;
+
+    static int _NextEnvRef;
+    static std::unordered_set<int> _LiveEnvs;
+
+    struct StateInfo
+    {
+        unsigned int serial;
+
+        // Heap size after the last full cycle
+        size_t gcBaseline;
+
+        // Milliseconds spent on the cycle in progress
+        double gcTime;
+
+        // Already warned about going over the limit during this cycle
+        bool gcOverLimit;
+    };
+
+    static std::unordered_map<lua_State *, StateInfo> _States;
+    static unsigned int _NextStateSerial;
+
+    static unsigned int _ReloadSerial;
+
+    // If a state grows this much past its baseline, it gets this many whole
+    // budgets on top of its share until it finishes a cycle, so memory can't
+    // run away without one frame paying for the entire cycle
+    static const size_t GC_LIMIT_FACTOR = 4;
+    static const size_t GC_MIN_BASELINE = 1024 * 1024;
+
+    // Kilobytes of work per lua_gc() step
+    static const int GC_STEP_SIZE = 16;
+
+    static double _GCBudget;
+    static double _GCTime;
+    static unsigned int _GCCycleCount;
+
+    // Index of the state StepGC() starts with next
+    static size_t _GCRotation;
+
+    static ScriptCache _Cache;
 
     bool _loaded = false;
 
+    bool _shared;
+
     lua_State * _luaState;
 
+    int _envRef;
+
+    double _loadTime;
+    size_t _memoryUsage;
+
+    struct WatchedFile
+    {
+        std::string filename;
+        FileWatcher::WatchID watch;
+    };
+
+    std::vector<WatchedFile> _files;
+
 }; // class ScriptHost
 
 } // namespace dusk
@@ -0,0 +1,104 @@
+#ifndef DUSK_SCRIPT_PROFILER_HPP
+#define DUSK_SCRIPT_PROFILER_HPP
+
+#include <dusk/Config.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dusk {
+
+// Sampling profiler for Lua. While running, a count hook on every state
+// walks the Lua stack every SAMPLE_INTERVAL instructions and charges the
+// time since the last sample to it. Calls into Lua from the engine, such as
+// event listeners, are timed exactly and label the samples taken inside them.
+// Only the main thread is profiled, parallel scripts are ignored.
+class ScriptProfiler
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(ScriptProfiler);
+
+    static const int SAMPLE_INTERVAL = 1000;
+
+    struct Entry
+    {
+        std::string name;
+        unsigned int calls = 0;
+        double total = 0.0; // ms
+        double self = 0.0;  // ms
+        double max = 0.0;   // ms
+    };
+
+    ScriptProfiler();
+    virtual ~ScriptProfiler();
+
+    void Start();
+    void Stop();
+    void Reset();
+
+    inline bool IsRunning() const { return _running; }
+
+    // Called by ScriptHost for states opened while running
+    void Attach(lua_State * L);
+
+    // Wrap every call from the engine into Lua, they can nest
+    void BeginCall(const std::string& label);
+    void EndCall();
+
+    // Sorted by time, most expensive first
+    std::vector<Entry> GetCalls() const;
+    std::vector<Entry> GetFunctions() const;
+    std::vector<Entry> GetLines() const;
+
+    // Writes "frame;frame;frame microseconds" lines, as read by flamegraph.pl
+    // and speedscope
+    bool ExportFolded(const std::string& filename) const;
+
+    inline unsigned int GetSampleCount() const { return _sampleCount; }
+
+private:
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Call
+    {
+        std::string label;
+        Clock::time_point start;
+    };
+
+    static void Hook(lua_State * L, lua_Debug * ar);
+
+    void Sample(lua_State * L);
+
+    inline bool IsMainThread() const { return std::this_thread::get_id() == _mainThread; }
+
+    static std::vector<Entry> Sorted(const std::unordered_map<std::string, Entry>& entries);
+
+    bool _running;
+
+    std::thread::id _mainThread;
+
+    std::vector<Call> _calls;
+    Clock::time_point _lastSample;
+
+    std::unordered_map<std::string, Entry> _callTimes;
+    std::unordered_map<std::string, Entry> _functionTimes;
+    std::unordered_map<std::string, Entry> _lineTimes;
+
+    // Folded stack to microseconds
+    std::unordered_map<std::string, double> _stacks;
+
+    unsigned int _sampleCount;
+
+    // Reused between samples
+    std::vector<std::string> _frames;
+
+}; // class ScriptProfiler
+
+} // namespace dusk
+
+#endif // DUSK_SCRIPT_PROFILER_HPP
@@ -0,0 +1,203 @@
+#ifndef DUSK_SCRIPT_SCHEDULER_HPP
+#define DUSK_SCRIPT_SCHEDULER_HPP
+
+#include <dusk/Config.hpp>
+#include <dusk/EventDispatcher.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dusk {
+
+// Hashed timing wheel. Entries are bucketed by deadline, so advancing only
+// looks at the slots that came due, never at everything that's waiting.
+class TimerWheel
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+
+    static const unsigned int SLOT_COUNT = 256;
+
+    TimerWheel() = default;
+    virtual ~TimerWheel() = default;
+
+    inline uint64_t GetNow() const { return _now; }
+
+    // Deadlines that have already passed fire on the next Advance()
+    void Add(uint64_t deadline, unsigned int id, unsigned int serial);
+
+    // Calls expire(id, serial) for every entry due by now
+    template <typename Func>
+    void Advance(uint64_t now, Func expire)
+    {
+        if (now <= _now)
+        {
+            return;
+        }
+
+        uint64_t steps = std::min<uint64_t>(now - _now, SLOT_COUNT);
+        for (uint64_t tick = _now + 1; tick <= _now + steps; ++tick)
+        {
+            std::vector<Entry>& slot = _slots[tick % SLOT_COUNT];
+            for (size_t i = 0; i < slot.size();)
+            {
+                if (slot[i].deadline > now)
+                {
+                    ++i;
+                    continue;
+                }
+
+                Entry entry = slot[i];
+                slot[i] = slot.back();
+                slot.pop_back();
+
+                expire(entry.id, entry.serial);
+            }
+        }
+
+        _now = now;
+    }
+
+private:
+
+    struct Entry
+    {
+        uint64_t deadline;
+        unsigned int id;
+        unsigned int serial;
+    };
+
+    uint64_t _now = 0;
+
+    std::vector<Entry> _slots[SLOT_COUNT];
+
+}; // class TimerWheel
+
+// Runs Lua functions as coroutines that can wait for time, frames or an
+// event. Waiting coroutines sit in a timer wheel or on an event listener
+// and cost nothing until they're woken, instead of polling from UPDATE.
+class ScriptScheduler
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(ScriptScheduler);
+
+    // Wheel resolution for WaitSeconds()
+    static const unsigned int TICKS_PER_SECOND = 100;
+
+    static const unsigned int INVALID_TASK = 0xFFFFFFFF;
+
+    ScriptScheduler();
+    virtual ~ScriptScheduler();
+
+    // Starts the function at the given stack index and runs it until it
+    // first waits. Returns a handle for Stop()
+    lua_Integer Start(lua_State * L, int index, int argCount);
+
+    void Stop(lua_Integer handle);
+
+    // Stops every coroutine started from the given state and environment
+    void StopAll(lua_State * L, int envRef);
+
+    // Called once per frame, resumes everything that woke up
+    void Update(double elapsed);
+
+    unsigned int GetRunningCount() const { return _runningCount; }
+    unsigned int GetResumedCount() const { return _resumedCount; }
+
+    // Coroutine threads of every live task
+    std::vector<lua_State *> GetThreads() const;
+
+    static void BindScripting(lua_State * L);
+
+    static int Script_StartCoroutine(lua_State * L);
+    static int Script_StopCoroutine(lua_State * L);
+    static int Script_WaitSeconds(lua_State * L);
+    static int Script_WaitFrames(lua_State * L);
+    static int Script_WaitForEvent(lua_State * L);
+
+private:
+
+    friend class WakeEventCallback;
+
+    enum class Wait : unsigned char
+    {
+        NONE,
+        SECONDS,
+        FRAMES,
+        EVENT,
+        READY,
+    };
+
+    struct Task
+    {
+        lua_State * luaState = nullptr;
+        unsigned int stateSerial = 0;
+        lua_State * thread = nullptr;
+        int threadRef = LUA_NOREF;
+        int envRef = LUA_NOREF;
+
+        unsigned int generation = 0;
+        unsigned int waitSerial = 0;
+        Wait wait = Wait::NONE;
+
+        bool live = false;
+        bool running = false;
+        bool stopping = false;
+
+        // Pushed as the result of the wait when resumed
+        int resumeArgs = 0;
+        bool eventFired = false;
+
+        IEventDispatcher * dispatcher = nullptr;
+        EventListenerID listener;
+
+        // Name in the profiler
+        std::string label;
+    };
+
+    struct Wakeup
+    {
+        unsigned int index;
+        unsigned int serial;
+    };
+
+    // The task whose coroutine is L, or null if L isn't one of ours
+    Task * GetTask(lua_State * L, unsigned int * index = nullptr);
+
+    // Records the wait and returns its serial
+    unsigned int BeginWait(unsigned int index, Wait wait);
+
+    void Wake(unsigned int index, unsigned int serial);
+    void WakeFromEvent(unsigned int index, unsigned int serial, bool fired);
+
+    void Resume(unsigned int index, int argCount);
+
+    void Release(unsigned int index);
+
+    std::vector<Task> _tasks;
+    std::vector<unsigned int> _freeTasks;
+
+    // Innermost task inside lua_resume()
+    unsigned int _current;
+
+    std::vector<Wakeup> _ready;
+    std::vector<Wakeup> _resuming;
+
+    TimerWheel _frameWheel;
+    TimerWheel _timeWheel;
+
+    uint64_t _frame;
+    double _time;
+
+    unsigned int _runningCount;
+    unsigned int _resumedCount;
+
+}; // class ScriptScheduler
+
+} // namespace dusk
+
+#endif // DUSK_SCRIPT_SCHEDULER_HPP
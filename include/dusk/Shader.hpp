@@ -2,6 +2,7 @@
 #define DUSK_SHADER_HPP
 
 #include <dusk/Config.hpp>
+#include <dusk/FileWatcher.hpp>
 
 #include <string>
 #include <vector>
@@ -28,8 +29,16 @@ public:
 
     void Bind();
 
+    // Rebuilds the program from the same files, keeping the old one if the
+    // new one fails to compile. Called when any of the files change
+    bool Reload();
+
     GLuint GetGLProgram() const { return _glProgram; }
 
+    // Instanced shaders read their model matrix from the per-instance attributes
+    void SetInstanced(bool instanced) { _instanced = instanced; }
+    bool IsInstanced() const { return _instanced; }
+
     GLint GetUniformLocation(const std::string& name);
 
     void BindData(const std::string& name);
@@ -39,6 +48,9 @@ public:
 
     static void UpdateData(const std::string& name, void * data, size_t size);
 
+    // Binding point of the named data block, or -1 if it was never added
+    static int GetDataIndex(const std::string& name);
+
 private:
 
 
@@ -54,13 +66,22 @@ private:
 
     std::vector<FileInfo> _files;
 
+    // Files pulled in with #include by the last load
+    std::vector<std::string> _includes;
+
+    std::vector<FileWatcher::WatchID> _watches;
+
     std::vector<std::string> _boundData;
     GLuint _glProgram;
 
-    bool LoadProgram();
+    bool _instanced;
+
+    GLuint LoadProgram();
     GLuint LoadShader(const std::string& filename, GLuint type);
 
-    static bool LoadFile(const std::string& filename, std::string& buffer);
+    void WatchFiles();
+
+    static bool LoadFile(const std::string& filename, std::string& buffer, std::vector<std::string> * includes = nullptr);
 
     static void PrintShader(const std::string& shader);
     static void PrintShaderLog(GLuint shader);
@@ -3,23 +3,36 @@
 
 #include <dusk/Config.hpp>
 
+#include <dusk/Asset.hpp>
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace dusk
 {
 
-class Sound
+class Sound : public ILoadable
 {
 public:
 
-    Sound(const std::string& filename);
+    DISALLOW_COPY_AND_ASSIGN(Sound);
+
+    static std::shared_ptr<Sound> Create(const std::string& filename);
     virtual ~Sound();
 
+    virtual bool Load() override;
+    virtual bool Upload() override;
+
     ALuint GetALBuffer() const { return _alBuffer; }
 
 protected:
 
+    Sound(const std::string& filename);
+
+    std::string _filename;
+
+    std::vector<unsigned char> _data;
+
     ALuint  _alBuffer;
     ALenum  _alFormat;
     ALsizei _alFreq;
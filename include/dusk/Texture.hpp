@@ -4,6 +4,8 @@
 #include <dusk/Config.hpp>
 
 #include <dusk/EventDispatcher.hpp>
+#include <dusk/Asset.hpp>
+#include <dusk/FileWatcher.hpp>
 #include <string>
 #include <memory>
 
@@ -12,6 +14,7 @@ namespace dusk {
 class Texture
     : public std::enable_shared_from_this<Texture>
     , public IEventDispatcher
+    , public ILoadable
 {
 public:
 
@@ -20,19 +23,49 @@ public:
     static std::shared_ptr<Texture> Create(const std::string& filename);
     ~Texture();
 
-    bool Load();
+    virtual bool Load() override;
+    virtual bool Upload() override;
+
     void Free();
 
+    // Decodes the file again and uploads it into a new GL texture, the old
+    // one stays in use until that succeeds, and for good if it fails. Called
+    // when the file changes
+    void Reload();
+
+    // Binds a placeholder until the texture is resident
     void Bind();
 
+    GLuint GetGLID() { return (IsLoaded() ? _glID : GetPlaceholder()); }
+
 private:
 
     Texture(const std::string& filename);
 
+    static GLuint GetPlaceholder();
+
+    static GLuint _GLPlaceholder;
+
     std::string _filename;
 
+    // Size of the image in the GL texture
+    int _width;
+    int _height;
+
+    // Written by Load() on a loader thread, taken over by Upload() on the
+    // main thread
+    int _decodedWidth;
+    int _decodedHeight;
+    unsigned char * _decodedPixels;
+
     GLuint _glID;
 
+    FileWatcher::WatchID _watch;
+
+    // Set while the loader has this texture, until the image is uploaded or
+    // fails to load, so Load() never runs twice at once
+    std::atomic<bool> _loading;
+
 }; // class Texture
 
 } // namespace dusk
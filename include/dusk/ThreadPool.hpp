@@ -0,0 +1,65 @@
+#ifndef DUSK_THREAD_POOL_HPP
+#define DUSK_THREAD_POOL_HPP
+
+#include <dusk/Config.hpp>
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace dusk {
+
+class ThreadPool
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+
+    // A thread count of 0 runs every job inline on the calling thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    virtual ~ThreadPool();
+
+    // Every core but the one for the main thread
+    static unsigned int GetDefaultThreadCount();
+
+    // The default split of those cores between asset loading in the
+    // background and work the main thread waits for each frame, so the
+    // pools together never outnumber the cores
+    static unsigned int GetDefaultLoaderThreadCount();
+    static unsigned int GetDefaultFrameThreadCount();
+
+    void SetThreadCount(unsigned int threadCount);
+    unsigned int GetThreadCount() const { return (unsigned int)_workers.size(); }
+
+    void Submit(std::function<void()> job);
+
+    // Block until every submitted job has finished
+    void Wait();
+
+private:
+
+    void Start(unsigned int threadCount);
+    void Stop();
+
+    void WorkerMain();
+
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _jobReady;
+    std::condition_variable _jobsDone;
+
+    std::queue<std::function<void()>> _jobs;
+
+    unsigned int _activeJobs = 0;
+
+    bool _stopping = false;
+
+}; // class ThreadPool
+
+} // namespace dusk
+
+#endif // DUSK_THREAD_POOL_HPP
@@ -0,0 +1,168 @@
+#ifndef DUSK_TRANSFORM_POOL_HPP
+#define DUSK_TRANSFORM_POOL_HPP
+
+#include <dusk/Config.hpp>
+
+#include <dusk/ThreadPool.hpp>
+#include <vector>
+
+namespace dusk {
+
+// Structure-of-arrays storage for every actor and model transform. Setters
+// only flag a slot dirty; Update() rebuilds the dirty local matrices and then
+// the world matrices in linear passes, so unchanged transforms cost nothing.
+//
+// Slots are kept sorted breadth first by hierarchy depth, so every parent is
+// finished before its children are reached and each depth level can be split
+// across worker threads.
+//
+// For rendering between fixed simulation steps, Interpolate() blends each
+// world matrix that changed in the last Update() with the one before it.
+class TransformPool
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(TransformPool);
+
+    static const unsigned int INVALID_HANDLE = 0xFFFFFFFF;
+
+    // Levels smaller than this are updated on the calling thread
+    static const unsigned int PARALLEL_THRESHOLD = 4096;
+
+    // Order the local matrix is built in
+    enum class Order : unsigned char
+    {
+        TRS, // translate * rotate * scale, used by actors
+        SRT, // scale * rotate * translate, used by models
+    };
+
+    // Large levels are split across the pool's workers, without one
+    // everything runs on the calling thread. The pool isn't owned
+    explicit TransformPool(ThreadPool * threadPool = nullptr);
+    virtual ~TransformPool();
+
+    unsigned int Allocate(Order order = Order::TRS, void * owner = nullptr);
+
+    // Children must be freed or reparented first
+    void Free(unsigned int handle);
+
+    void SetPosition(unsigned int handle, const glm::vec3& pos);
+    const glm::vec3& GetPosition(unsigned int handle) const { return _position[_dense[handle]]; }
+
+    void SetRotation(unsigned int handle, const glm::vec3& rot);
+    const glm::vec3& GetRotation(unsigned int handle) const { return _rotation[_dense[handle]]; }
+
+    void SetScale(unsigned int handle, const glm::vec3& scale);
+    const glm::vec3& GetScale(unsigned int handle) const { return _scale[_dense[handle]]; }
+
+    // Bulk versions, values holds x, y, z for each handle in turn
+    void SetPositions(const unsigned int * handles, size_t count, const float * values);
+    void GetPositions(const unsigned int * handles, size_t count, float * values) const;
+
+    void SetRotations(const unsigned int * handles, size_t count, const float * values);
+    void GetRotations(const unsigned int * handles, size_t count, float * values) const;
+
+    void SetScales(const unsigned int * handles, size_t count, const float * values);
+    void GetScales(const unsigned int * handles, size_t count, float * values) const;
+
+    void SetBase(unsigned int handle, const glm::mat4& base);
+    const glm::mat4& GetBase(unsigned int handle) const { return _base[_dense[handle]]; }
+
+    // The parent's world matrix is applied before base and local. Returns
+    // false if the link would create a cycle
+    bool SetParent(unsigned int handle, unsigned int parent);
+    unsigned int GetParent(unsigned int handle) const { return _parent[_dense[handle]]; }
+
+    // World matrix as of the last Update()
+    const glm::mat4& GetWorld(unsigned int handle) const { return _world[_dense[handle]]; }
+
+    // Bumped every time the world matrix is rebuilt
+    unsigned int GetVersion(unsigned int handle) const { return _version[_dense[handle]]; }
+
+    // World matrix as of the last Interpolate(), or Update() if later
+    const glm::mat4& GetRenderWorld(unsigned int handle) const { return _render[_dense[handle]]; }
+
+    // Bumped every time the render matrix changes
+    unsigned int GetRenderVersion(unsigned int handle) const { return _renderVersion[_dense[handle]]; }
+
+    void * GetOwner(unsigned int handle) const { return _owner[_dense[handle]]; }
+
+    // Forces the world matrix to be rebuilt and reported by the next Update()
+    void MarkDirty(unsigned int handle) { _dirty[_dense[handle]] = 1; }
+
+    void Update();
+
+    // alpha is how far we are from the previous Update() to the last one,
+    // 1 shows the latest state. Slots are blended by position, rotation and
+    // scale, so call at most once per rendered frame
+    void Interpolate(float alpha);
+
+    // Handles whose world matrix changed in the last Update()
+    const std::vector<unsigned int>& GetChanged() const { return _changed; }
+
+    size_t GetCount() const { return _handles.size(); }
+
+    // Number of hierarchy levels as of the last Update()
+    size_t GetDepth() const { return (_levels.empty() ? 0 : _levels.size() - 1); }
+
+private:
+
+    void SortHierarchy();
+
+    template <typename T>
+    void Permute(std::vector<T>& data);
+
+    // Runs func(begin, end) over chunks of [begin, end), in parallel when large
+    template <typename Func>
+    void ParallelFor(unsigned int begin, unsigned int end, Func func);
+
+    void SetMany(std::vector<glm::vec3>& data, const unsigned int * handles, size_t count, const float * values);
+    void GetMany(const std::vector<glm::vec3>& data, const unsigned int * handles, size_t count, float * values) const;
+
+    void UpdateLocals(unsigned int begin, unsigned int end);
+    void UpdateWorlds(unsigned int begin, unsigned int end);
+
+    // Indexed by handle
+    std::vector<unsigned int> _dense;
+    std::vector<unsigned int> _freeHandles;
+
+    // Indexed by dense index
+    std::vector<unsigned int> _handles;
+    std::vector<glm::vec3> _position;
+    std::vector<glm::vec3> _rotation;
+    std::vector<glm::vec3> _scale;
+    std::vector<glm::mat4> _base;
+    std::vector<glm::mat4> _local;
+    std::vector<glm::mat4> _world;
+    std::vector<glm::mat4> _previous;
+    std::vector<glm::mat4> _render;
+    std::vector<unsigned int> _parent;
+    std::vector<unsigned int> _version;
+    std::vector<unsigned int> _renderVersion;
+    std::vector<unsigned char> _dirty;
+    std::vector<unsigned char> _updated;
+    std::vector<Order> _order;
+    std::vector<void *> _owner;
+
+    std::vector<unsigned int> _changed;
+
+    // Alpha the render matrices of the changed slots were last built with
+    float _alpha;
+
+    // Set when slots are added, removed or reparented
+    bool _hierarchyDirty;
+
+    // Start of each depth level in the dense arrays, plus the end
+    std::vector<unsigned int> _levels;
+
+    // Scratch space for SortHierarchy()
+    std::vector<unsigned int> _depth;
+    std::vector<unsigned int> _sortOrder;
+
+    ThreadPool * _pool;
+
+}; // class TransformPool
+
+} // namespace dusk
+
+#endif // DUSK_TRANSFORM_POOL_HPP
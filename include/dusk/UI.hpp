@@ -5,6 +5,7 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 
 namespace dusk {
 
@@ -21,6 +22,8 @@ public:
     static void Log(ImVec4 color, const char * message);
 
     static bool ConsoleShown;
+    static bool RenderStatsShown;
+    static bool ProfilerShown;
 
 private:
 
@@ -29,6 +32,7 @@ private:
         std::string message;
     };
 
+    static std::mutex _logMutex;
     static std::vector<LogItem> _logItems;
 
 };
@@ -0,0 +1,61 @@
+#ifndef DUSK_UNIFORM_RING_HPP
+#define DUSK_UNIFORM_RING_HPP
+
+#include <dusk/Config.hpp>
+
+#include <vector>
+
+namespace dusk {
+
+// One large uniform buffer split into a region per frame in flight. Each frame
+// writes into its own region and fences it, so mapping never waits on the GPU
+// unless it falls a full ring behind.
+class UniformRing
+{
+public:
+
+    DISALLOW_COPY_AND_ASSIGN(UniformRing);
+
+    explicit UniformRing(unsigned int frameCount = 3);
+    virtual ~UniformRing();
+
+    // Maps the next region, growing the ring if it is smaller than size
+    bool BeginFrame(size_t size);
+
+    // Copies data into the mapped region, returns the aligned offset
+    GLintptr Write(const void * data, size_t size);
+
+    // Unmaps the region, must be called before drawing with it
+    void EndWrite();
+
+    // Fences the region once every draw reading from it has been issued
+    void EndFrame();
+
+    void BindRange(GLuint index, GLintptr offset, size_t size);
+
+    size_t GetBytesWritten() const { return _writeOffset; }
+
+    // Rounds size up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    size_t Align(size_t size) const { return (size + _alignment - 1) & ~(_alignment - 1); }
+
+private:
+
+    void Resize(size_t frameSize);
+
+    unsigned int _frameCount;
+    unsigned int _frameIndex;
+
+    size_t _alignment;
+    size_t _frameSize;
+    size_t _writeOffset;
+
+    GLuint _glUBO;
+    GLbyte * _mapped;
+
+    std::vector<GLsync> _fences;
+
+}; // class UniformRing
+
+} // namespace dusk
+
+#endif // DUSK_UNIFORM_RING_HPP
@@ -2,17 +2,23 @@
 
 #include <dusk/Benchmark.hpp>
 #include <dusk/Scene.hpp>
+#include <dusk/App.hpp>
+#include <dusk/FloatBuffer.hpp>
+#include <dusk/ScriptCommandBuffer.hpp>
+#include <algorithm>
+#include <tuple>
 
 namespace dusk {
 
 Actor::Actor(bool isTempalte /*= false*/)
     : _scene(nullptr)
     , _isTemplate(isTempalte)
-    , _baseTransform(1)
-    , _transform(1)
-    , _position(0)
-    , _rotation(0)
-    , _scale(1)
+    , _transformPool(App::GetInst()->GetTransformPool())
+    , _transformHandle(_transformPool->Allocate(TransformPool::Order::TRS, this))
+    , _parent(nullptr)
+    , _children()
+    , _worldBounds()
+    , _bvhProxy(BVH::NULL_NODE)
 {
 }
 
@@ -75,165 +81,391 @@ std::unique_ptr<Actor> Actor::Clone()
 
 Actor::~Actor()
 {
-    if (GetScene() && !IsTemplate())
+    if (GetScene())
     {
-        GetScene()->RemoveEventListener((EventID)Scene::Events::UPDATE, this, &Actor::Update);
-        GetScene()->RemoveEventListener((EventID)Scene::Events::RENDER, this, &Actor::Render);
+        for (auto& component : _components)
+        {
+            component->RemoveFromScene(GetScene());
+        }
+
+        if (!IsTemplate())
+        {
+            GetScene()->RemoveActorBounds(this);
+        }
     }
+
+    SetParent(nullptr);
+
+    // Detach from the back since each child removes itself from the list
+    while (!_children.empty())
+    {
+        _children.back()->SetParent(nullptr);
+    }
+
+    // Model transforms are parented to ours
+    _components.clear();
+    _transformPool->Free(_transformHandle);
 }
 
 void Actor::SetScene(Scene * scene)
 {
-    if (GetScene() && !IsTemplate())
+    if (GetScene())
     {
-        GetScene()->RemoveEventListener((EventID)Scene::Events::UPDATE, this, &Actor::Update);
-        GetScene()->RemoveEventListener((EventID)Scene::Events::RENDER, this, &Actor::Render);
+        for (auto& component : _components)
+        {
+            component->RemoveFromScene(GetScene());
+        }
     }
 
     _scene = scene;
 
-    if (!IsTemplate())
+    // Make sure the new scene sees our bounds on the next update
+    _transformPool->MarkDirty(_transformHandle);
+
+    if (GetScene())
+    {
+        for (auto& component : _components)
+        {
+            component->AddToScene(GetScene());
+        }
+    }
+}
+
+void Actor::SetParent(Actor * parent)
+{
+    if (parent == _parent)
+    {
+        return;
+    }
+
+    unsigned int parentHandle = (parent ? parent->GetTransformHandle() : TransformPool::INVALID_HANDLE);
+    if (!_transformPool->SetParent(_transformHandle, parentHandle))
+    {
+        return;
+    }
+
+    if (_parent)
     {
-        GetScene()->AddEventListener((EventID)Scene::Events::UPDATE, this, &Actor::Update);
-        GetScene()->AddEventListener((EventID)Scene::Events::RENDER, this, &Actor::Render);
+        auto it = std::find(_parent->_children.begin(), _parent->_children.end(), this);
+        if (it != _parent->_children.end())
+        {
+            _parent->_children.erase(it);
+        }
+    }
+
+    _parent = parent;
+
+    if (_parent)
+    {
+        _parent->_children.push_back(this);
     }
 }
 
 void Actor::SetBaseTransform(const glm::mat4& baseTransform)
 {
-    _baseTransform = baseTransform;
+    _transformPool->SetBase(_transformHandle, baseTransform);
 }
 
 void Actor::SetPosition(const glm::vec3& pos)
 {
-    _position = pos;
+    _transformPool->SetPosition(_transformHandle, pos);
 }
 
 void Actor::SetRotation(const glm::vec3& rot)
 {
-    _rotation = rot;
+    _transformPool->SetRotation(_transformHandle, rot);
 }
 
 void Actor::SetScale(const glm::vec3& scale)
 {
-    _scale = scale;
+    _transformPool->SetScale(_transformHandle, scale);
 }
 
-glm::mat4 Actor::GetTransform()
+void Actor::UpdateBounds()
 {
-    _transform = _baseTransform;
-    _transform = glm::translate(_transform, _position);
-    _transform = glm::rotate(_transform, _rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
-    _transform = glm::rotate(_transform, _rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
-    _transform = glm::rotate(_transform, _rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
-    _transform = glm::scale(_transform, _scale);
+    if (!GetScene() || IsTemplate())
+    {
+        return;
+    }
+
+    AABB previous = _worldBounds;
+    _worldBounds = AABB();
+
+    for (auto& component : _components)
+    {
+        component->ExpandBounds(_worldBounds);
+    }
 
-    return _transform;
+    if (_worldBounds != previous)
+    {
+        GetScene()->UpdateActorBounds(this);
+    }
 }
 
 void Actor::AddComponent(std::unique_ptr<Component> comp)
 {
     comp->SetActor(this);
+
+    if (GetScene())
+    {
+        comp->AddToScene(GetScene());
+    }
+
     _components.push_back(std::move(comp));
 }
 
 void Actor::Update(const Event& event)
 {
-    DispatchEvent(Event((EventID)Events::UPDATE, event.GetData()));
+    if (HasEventListeners((EventID)Events::UPDATE))
+    {
+        DispatchEvent(Event((EventID)Events::UPDATE, event.GetData()));
+    }
 }
 
 void Actor::Render(const Event& event)
 {
-    DispatchEvent(Event((EventID)Events::RENDER));
+    for (auto& component : _components)
+    {
+        component->OnRender(event);
+    }
+
+    if (HasEventListeners((EventID)Events::RENDER))
+    {
+        DispatchEvent(Event((EventID)Events::RENDER));
+    }
+}
+
+// Parallel scripts can't touch the transform pool, their changes are queued
+static void ScriptSetTransform(Actor& actor, ScriptCommandBuffer::Type type, const glm::vec3& value)
+{
+    ScriptCommandBuffer * commands = ScriptCommandBuffer::GetCurrent();
+    if (commands)
+    {
+        commands->Push(type, actor.GetTransformHandle(), value);
+        return;
+    }
+
+    switch (type)
+    {
+    case ScriptCommandBuffer::Type::SET_POSITION:
+        actor.SetPosition(value);
+        break;
+    case ScriptCommandBuffer::Type::SET_ROTATION:
+        actor.SetRotation(value);
+        break;
+    case ScriptCommandBuffer::Type::SET_SCALE:
+        actor.SetScale(value);
+        break;
+    }
 }
 
 void Actor::InitScripting()
 {
-    ScriptHost::AddFunction("dusk_Actor_GetPosition", &Actor::Script_GetPosition);
-    ScriptHost::AddFunction("dusk_Actor_SetPosition", &Actor::Script_SetPosition);
-    ScriptHost::AddFunction("dusk_Actor_GetRotation", &Actor::Script_GetRotation);
-    ScriptHost::AddFunction("dusk_Actor_SetRotation", &Actor::Script_SetRotation);
-    ScriptHost::AddFunction("dusk_Actor_GetScale", &Actor::Script_GetScale);
-    ScriptHost::AddFunction("dusk_Actor_SetScale", &Actor::Script_SetScale);
+    ScriptHost::AddBinding(&Actor::BindScripting);
 }
 
-int Actor::Script_GetPosition(lua_State * L)
+void Actor::BindScripting(lua_State * L)
 {
-    Actor * actor = (Actor *)lua_tointeger(L, 1);
-    glm::vec3 pos = actor->GetPosition();
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    // Get* return a Dusk.Vec3, which is a userdata allocation per call. The
+    // *XYZ versions return three numbers and allocate nothing, for hot loops
+    dusk.new_usertype<Actor>("Actor",
+        "new", sol::no_constructor,
+        sol::base_classes, sol::bases<IEventDispatcher>(),
+        "Events", sol::var(lua.create_table_with(
+            "UPDATE", (EventID)Events::UPDATE,
+            "RENDER", (EventID)Events::RENDER)),
+        "GetScene", &Actor::GetScene,
+        "GetPosition", &Actor::GetPosition,
+        "GetPositionXYZ", [](const Actor& actor) {
+            glm::vec3 value = actor.GetPosition();
+            return std::make_tuple(value.x, value.y, value.z);
+        },
+        "SetPosition", sol::overload(
+            [](Actor& actor, const glm::vec3& pos) {
+                ScriptSetTransform(actor, ScriptCommandBuffer::Type::SET_POSITION, pos);
+            },
+            [](Actor& actor, float x, float y, float z) {
+                ScriptSetTransform(actor, ScriptCommandBuffer::Type::SET_POSITION, glm::vec3(x, y, z));
+            }),
+        "GetRotation", &Actor::GetRotation,
+        "GetRotationXYZ", [](const Actor& actor) {
+            glm::vec3 value = actor.GetRotation();
+            return std::make_tuple(value.x, value.y, value.z);
+        },
+        "SetRotation", sol::overload(
+            [](Actor& actor, const glm::vec3& rot) {
+                ScriptSetTransform(actor, ScriptCommandBuffer::Type::SET_ROTATION, rot);
+            },
+            [](Actor& actor, float x, float y, float z) {
+                ScriptSetTransform(actor, ScriptCommandBuffer::Type::SET_ROTATION, glm::vec3(x, y, z));
+            }),
+        "GetScale", &Actor::GetScale,
+        "GetScaleXYZ", [](const Actor& actor) {
+            glm::vec3 value = actor.GetScale();
+            return std::make_tuple(value.x, value.y, value.z);
+        },
+        "SetScale", sol::overload(
+            [](Actor& actor, const glm::vec3& scale) {
+                ScriptSetTransform(actor, ScriptCommandBuffer::Type::SET_SCALE, scale);
+            },
+            [](Actor& actor, float x, float y, float z) {
+                ScriptSetTransform(actor, ScriptCommandBuffer::Type::SET_SCALE, glm::vec3(x, y, z));
+            }),
+        "GetParent", &Actor::GetParent,
+        "SetParent", ScriptCommandBuffer::MainThreadOnly(&Actor::SetParent, "Actor:SetParent"),
+        "SetPositions", &Actor::Script_SetPositions,
+        "GetPositions", &Actor::Script_GetPositions,
+        "SetRotations", &Actor::Script_SetRotations,
+        "GetRotations", &Actor::Script_GetRotations,
+        "SetScales", &Actor::Script_SetScales,
+        "GetScales", &Actor::Script_GetScales);
+}
 
-    lua_pushnumber(L, pos.x);
-    lua_pushnumber(L, pos.y);
-    lua_pushnumber(L, pos.z);
+typedef void (TransformPool::*BulkSetter)(const unsigned int *, size_t, const float *);
+typedef void (TransformPool::*BulkGetter)(const unsigned int *, size_t, float *) const;
 
-    return 3;
-}
+// Parallel scripts call these from worker threads, so each gets its own scratch
+static thread_local std::vector<unsigned int> _ScriptHandles;
+static thread_local std::vector<float> _ScriptValues;
 
-int Actor::Script_SetPosition(lua_State * L)
+static size_t GatherHandles(lua_State * L)
 {
-    Actor * actor = (Actor *)lua_tointeger(L, 1);
-    glm::vec3 pos;
-
-    pos.x = (float)lua_tonumber(L, 2);
-    pos.y = (float)lua_tonumber(L, 3);
-    pos.z = (float)lua_tonumber(L, 4);
+    luaL_checktype(L, 1, LUA_TTABLE);
 
-    actor->SetPosition(pos);
+    size_t count = lua_rawlen(L, 1);
+    _ScriptHandles.resize(count);
 
-    return 0;
-}
+    for (size_t i = 0; i < count; ++i)
+    {
+        lua_rawgeti(L, 1, (lua_Integer)i + 1);
+        sol::optional<Actor *> actor = sol::stack::check_get<Actor *>(L, -1);
+        lua_pop(L, 1);
 
-int Actor::Script_GetRotation(lua_State * L)
-{
-    Actor * actor = (Actor *)lua_tointeger(L, 1);
-    glm::vec3 rot = actor->GetRotation();
+        if (!actor || !actor.value())
+        {
+            return luaL_error(L, "element %d of the actor array is not an actor", (int)i + 1);
+        }
 
-    lua_pushnumber(L, rot.x);
-    lua_pushnumber(L, rot.y);
-    lua_pushnumber(L, rot.z);
+        _ScriptHandles[i] = actor.value()->GetTransformHandle();
+    }
 
-    return 3;
+    return count;
 }
 
-int Actor::Script_SetRotation(lua_State * L)
+static int ScriptBulkSet(lua_State * L, BulkSetter setter, ScriptCommandBuffer::Type type)
 {
-    Actor * actor = (Actor *)lua_tointeger(L, 1);
-    glm::vec3 rot;
+    size_t count = GatherHandles(L);
+    const float * values = nullptr;
 
-    rot.x = (float)lua_tonumber(L, 2);
-	rot.y = (float)lua_tonumber(L, 3);
-	rot.z = (float)lua_tonumber(L, 4);
+    sol::optional<FloatBuffer *> buffer = sol::stack::check_get<FloatBuffer *>(L, 2);
+    if (buffer && buffer.value())
+    {
+        luaL_argcheck(L, buffer.value()->GetSize() >= count * 3, 2, "buffer is too small");
+        values = buffer.value()->GetData();
+    }
+    else
+    {
+        luaL_checktype(L, 2, LUA_TTABLE);
+        luaL_argcheck(L, lua_rawlen(L, 2) >= count * 3, 2, "table is too small");
+
+        _ScriptValues.resize(count * 3);
+        for (size_t i = 0; i < count * 3; ++i)
+        {
+            lua_rawgeti(L, 2, (lua_Integer)i + 1);
+            _ScriptValues[i] = (float)lua_tonumber(L, -1);
+            lua_pop(L, 1);
+        }
+
+        values = _ScriptValues.data();
+    }
 
-    actor->SetRotation(rot);
+    ScriptCommandBuffer * commands = ScriptCommandBuffer::GetCurrent();
+    if (commands)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            commands->Push(type, _ScriptHandles[i], glm::vec3(values[i * 3], values[i * 3 + 1], values[i * 3 + 2]));
+        }
+        return 0;
+    }
+
+    (App::GetInst()->GetTransformPool()->*setter)(_ScriptHandles.data(), count, values);
 
     return 0;
 }
 
-int Actor::Script_GetScale(lua_State * L)
+static int ScriptBulkGet(lua_State * L, BulkGetter getter)
 {
-    Actor * actor = (Actor *)lua_tointeger(L, 1);
-    glm::vec3 scale = actor->GetScale();
+    size_t count = GatherHandles(L);
+    TransformPool * pool = App::GetInst()->GetTransformPool();
 
-    lua_pushnumber(L, scale.x);
-    lua_pushnumber(L, scale.y);
-    lua_pushnumber(L, scale.z);
+    // Fill the caller's buffer when given one, so nothing is allocated
+    if (lua_isnoneornil(L, 2))
+    {
+        lua_settop(L, 1);
+        sol::stack::push(L, FloatBuffer(count * 3));
+    }
 
-    return 3;
+    sol::optional<FloatBuffer *> buffer = sol::stack::check_get<FloatBuffer *>(L, 2);
+    if (buffer && buffer.value())
+    {
+        if (buffer.value()->GetSize() < count * 3)
+        {
+            buffer.value()->Resize(count * 3);
+        }
+
+        (pool->*getter)(_ScriptHandles.data(), count, buffer.value()->GetData());
+    }
+    else
+    {
+        luaL_checktype(L, 2, LUA_TTABLE);
+
+        _ScriptValues.resize(count * 3);
+        (pool->*getter)(_ScriptHandles.data(), count, _ScriptValues.data());
+
+        for (size_t i = 0; i < count * 3; ++i)
+        {
+            lua_pushnumber(L, _ScriptValues[i]);
+            lua_rawseti(L, 2, (lua_Integer)i + 1);
+        }
+    }
+
+    lua_settop(L, 2);
+
+    return 1;
 }
 
-int Actor::Script_SetScale(lua_State * L)
+int Actor::Script_SetPositions(lua_State * L)
 {
-    Actor * actor = (Actor *)lua_tointeger(L, 1);
-    glm::vec3 scale;
+    return ScriptBulkSet(L, &TransformPool::SetPositions, ScriptCommandBuffer::Type::SET_POSITION);
+}
 
-    scale.x = (float)lua_tonumber(L, 2);
-	scale.y = (float)lua_tonumber(L, 3);
-	scale.z = (float)lua_tonumber(L, 4);
+int Actor::Script_GetPositions(lua_State * L)
+{
+    return ScriptBulkGet(L, &TransformPool::GetPositions);
+}
 
-    actor->SetScale(scale);
+int Actor::Script_SetRotations(lua_State * L)
+{
+    return ScriptBulkSet(L, &TransformPool::SetRotations, ScriptCommandBuffer::Type::SET_ROTATION);
+}
 
-    return 0;
+int Actor::Script_GetRotations(lua_State * L)
+{
+    return ScriptBulkGet(L, &TransformPool::GetRotations);
 }
 
+int Actor::Script_SetScales(lua_State * L)
+{
+    return ScriptBulkSet(L, &TransformPool::SetScales, ScriptCommandBuffer::Type::SET_SCALE);
+}
+
+int Actor::Script_GetScales(lua_State * L)
+{
+    return ScriptBulkGet(L, &TransformPool::GetScales);
+}
 
 } // namespace dusk
@@ -2,6 +2,9 @@
 
 #include <dusk/Log.hpp>
 #include <dusk/Benchmark.hpp>
+#include <dusk/ScriptScheduler.hpp>
+#include <dusk/ScriptCommandBuffer.hpp>
+#include <cmath>
 #include <fstream>
 #include <memory>
 
@@ -9,13 +12,31 @@ namespace dusk {
 
 App * App::_Inst = nullptr;
 
+const double App::DEFAULT_UPDATE_RATE = 60.0;
+
 App::App(int argc, char** argv)
-    : _textureCache(new AssetCache<Texture>())
+    : _updateStep(1.0 / DEFAULT_UPDATE_RATE)
+    , _updateAccumulator(0.0)
+    , _maxUpdateSteps(5)
+    , _interpolationAlpha(1.0f)
+    , _droppedUpdateTime(0.0)
+    , _droppedUpdateFrames(0)
+    , _droppingUpdates(false)
+    , _fileWatcher(new FileWatcher())
+    , _textureCache(new AssetCache<Texture>())
     , _textureIndex(new AssetIndex<Texture>())
     , _meshCache(new AssetCache<Mesh>())
     , _meshIndex(new AssetIndex<Mesh>())
     , _materialCache(new AssetCache<Material>())
     , _materialIndex(new AssetIndex<Material>())
+    , _soundCache(new AssetCache<Sound>())
+    , _soundIndex(new AssetIndex<Sound>())
+    , _eventQueue(new EventQueue())
+    , _eventBus(new EventBus())
+    , _assetLoader(new AssetLoader())
+    , _workerPool(new ThreadPool(ThreadPool::GetDefaultFrameThreadCount()))
+    , _transformPool(new TransformPool(_workerPool.get()))
+    , _framePacer(new FramePacer())
 {
     App::InitScripting();
 
@@ -65,6 +86,9 @@ void App::CreateWindow()
 
     glfwMakeContextCurrent(_glfwWindow);
 
+    // Needs a context for the swap interval
+    _framePacer->SetMode(_framePacer->GetMode());
+
     if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress))
     {
         DuskLogError("Failed to initialize OpenGL context");
@@ -163,6 +187,59 @@ void App::LoadConfig(const std::string& filename)
 		ParseWindow(data["Window"]);
 	}
 
+    if (data.find("AssetThreads") != data.end())
+    {
+        unsigned int assetThreads = data["AssetThreads"];
+        _assetLoader->SetThreadCount(assetThreads);
+
+        // The loaders take their cores from the frame workers
+        unsigned int cores = ThreadPool::GetDefaultThreadCount();
+        _workerPool->SetThreadCount(cores > assetThreads ? cores - assetThreads : 0);
+    }
+
+    if (data.find("ScriptGCBudget") != data.end())
+    {
+        ScriptHost::SetGCBudget(data["ScriptGCBudget"]);
+    }
+
+    if (data.find("FrameMode") != data.end())
+    {
+        FramePacer::Mode mode;
+        if (FramePacer::ParseMode(data["FrameMode"].get<std::string>(), mode))
+        {
+            _framePacer->SetMode(mode);
+        }
+        else
+        {
+            DuskLogWarn("Unknown frame mode '%s'", data["FrameMode"].get<std::string>().c_str());
+        }
+    }
+
+    if (data.find("TargetFPS") != data.end())
+    {
+        _framePacer->SetTargetFPS(data["TargetFPS"]);
+    }
+
+    if (data.find("UpdateRate") != data.end())
+    {
+        SetUpdateRate(data["UpdateRate"]);
+    }
+
+    if (data.find("MaxUpdateSteps") != data.end())
+    {
+        SetMaxUpdateSteps(data["MaxUpdateSteps"]);
+    }
+
+    if (data.find("HotReload") != data.end())
+    {
+        _fileWatcher->SetEnabled(data["HotReload"]);
+    }
+
+    if (data.find("ScriptCache") != data.end())
+    {
+        ScriptHost::GetCache().SetDirectory(data["ScriptCache"].get<std::string>());
+    }
+
     for (auto& shader : data["Shaders"])
     {
         _shaders[shader["ID"]] = Shader::Parse(shader);
@@ -200,41 +277,81 @@ void App::Run()
 
     DispatchEvent(Event((EventID)App::Events::START));
 
-    double frame_delay = 1.0;   // MS until next frame
-    double frame_elap  = 0.0;   // MS since last frame
-    double fps_delay   = 250.0; // MS until next FPS update
-    double fps_elap    = 0.0;   // MS since last FPS update
-    double elapsed;
-
-    unsigned long frames = 0;
-
     UpdateEventData updateEventData;
 
-    updateEventData.SetTargetFPS(TARGET_FPS);
-    frame_delay = (1000.0 / TARGET_FPS) / 1000.0;
-
     if (_scene)
     {
         _scene->Start();
     }
 
-    double timeOffset = glfwGetTime();
+    _framePacer->Reset();
     while (!glfwWindowShouldClose(_glfwWindow))
     {
-        // TODO: Cleanup
-        elapsed = glfwGetTime() - timeOffset;
-        timeOffset = glfwGetTime();
+        double elapsed = _framePacer->BeginFrame();
 
         glfwPollEvents();
 
-        updateEventData.Update(elapsed);
-        DispatchEvent(Event((EventID)Events::UPDATE, updateEventData));
+        // Nothing to draw while minimized, so don't spin on it
+        _framePacer->SetIdle(GLFW_TRUE == glfwGetWindowAttrib(_glfwWindow, GLFW_ICONIFIED));
 
-        frame_elap += elapsed;
-        if (frame_delay <= frame_elap)
+        // Changed assets reload between frames, never in the middle of one
+        _fileWatcher->Poll();
+
+        _assetLoader->ProcessCompleted();
+
+        // Events from worker threads, then what was posted last frame and
+        // by input callbacks
+        _eventBus->Dispatch();
+        _eventQueue->Dispatch();
+
+        updateEventData.SetDeltaRate((float)(_updateStep > 0.0 ? GetUpdateRate() : _framePacer->GetTargetFPS()));
+        updateEventData.SetCurrentFPS((float)_framePacer->GetCurrentFPS());
+
+        if (_updateStep > 0.0)
+        {
+            _updateAccumulator += elapsed;
+
+            unsigned int steps = 0;
+            while (_updateAccumulator >= _updateStep && steps < _maxUpdateSteps)
+            {
+                Step(updateEventData, _updateStep);
+
+                _updateAccumulator -= _updateStep;
+                ++steps;
+            }
+
+            if (_updateAccumulator >= _updateStep)
+            {
+                double dropped = _updateAccumulator - std::fmod(_updateAccumulator, _updateStep);
+
+                // Under sustained load this happens every frame, the stats window has the totals
+                if (!_droppingUpdates)
+                {
+                    DuskLogPerf("Dropped %.1f ms of updates to catch up", dropped * 1000.0);
+                }
+
+                _droppingUpdates = true;
+                _droppedUpdateTime += dropped * 1000.0;
+                ++_droppedUpdateFrames;
+
+                _updateAccumulator = std::fmod(_updateAccumulator, _updateStep);
+            }
+            else
+            {
+                _droppingUpdates = false;
+            }
+
+            _interpolationAlpha = (float)(_updateAccumulator / _updateStep);
+        }
+        else
+        {
+            Step(updateEventData, elapsed);
+            _interpolationAlpha = 1.0f;
+        }
+
+        if (!_framePacer->IsIdle())
         {
-            frame_elap = 0.0;
-            ++frames;
+            _transformPool->Interpolate(_interpolationAlpha);
 
             ImGui_ImplGlfwGL3_NewFrame();
 
@@ -247,20 +364,15 @@ void App::Run()
             glfwSwapBuffers(_glfwWindow);
         }
 
-        fps_elap += elapsed;
-        if (fps_delay <= fps_elap)
-        {
-            float fps = (float)((frames / fps_elap) * 1000.0f);
-            updateEventData.SetCurrentFPS(fps);
+        // Before we wait for the next frame, let Lua collect
+        ScriptHost::StepGC();
 
-            frames = 0;
-            fps_elap = 0.0;
-        }
+        _framePacer->EndFrame();
     }
 
     DispatchEvent(Event((EventID)App::Events::STOP));
 
-    if (!_scene)
+    if (_scene)
     {
         _scene->Stop();
     }
@@ -268,42 +380,61 @@ void App::Run()
     glfwHideWindow(_glfwWindow);
 }
 
-void App::InitScripting()
+void App::Step(UpdateEventData& updateEventData, double elapsed)
 {
-    ScriptHost::AddFunction("dusk_App_GetInst", &App::Script_GetInst);
-    ScriptHost::AddFunction("dusk_App_LoadConfig", &App::Script_LoadConfig);
-    ScriptHost::AddFunction("dusk_App_GetScene", &App::Script_GetScene);
+    updateEventData.Update(elapsed);
+    DispatchEvent(Event((EventID)Events::UPDATE, updateEventData));
 
-    IEventDispatcher::InitScripting();
+    ScriptHost::GetScheduler().Update(elapsed);
 
-    Scene::InitScripting();
-    Actor::InitScripting();
-    Component::InitScripting();
+    // Anything posted during update is seen before the next one, or render
+    _eventQueue->Dispatch();
 }
 
-int App::Script_GetInst(lua_State * L)
+void App::SetUpdateRate(double rate)
 {
-    lua_pushinteger(L, (ptrdiff_t)App::GetInst());
+    if (rate < 0.0)
+    {
+        DuskLogWarn("Ignoring invalid update rate %f", rate);
+        return;
+    }
 
-    return 1;
+    _updateStep = (rate > 0.0 ? 1.0 / rate : 0.0);
+    _updateAccumulator = 0.0;
 }
 
-int App::Script_LoadConfig(lua_State * L)
+void App::InitScripting()
 {
-    App * app = (App *)lua_tointeger(L, 1);
+    ScriptHost::AddBinding(&App::BindScripting);
 
-    app->LoadConfig(std::string(lua_tostring(L, 2)));
+    IEventDispatcher::InitScripting();
 
-    return 0;
+    Scene::InitScripting();
+    Actor::InitScripting();
+    Component::InitScripting();
+    Camera::InitScripting();
+    FloatBuffer::InitScripting();
 }
 
-int App::Script_GetScene(lua_State * L)
+void App::BindScripting(lua_State * L)
 {
-    App * app = (App *)lua_tointeger(L, 1);
-
-    lua_pushinteger(L, (ptrdiff_t)app->GetScene());
-
-    return 1;
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    dusk.new_usertype<App>("App",
+        "new", sol::no_constructor,
+        sol::base_classes, sol::bases<IEventDispatcher>(),
+        "Events", sol::var(lua.create_table_with(
+            "UPDATE", (EventID)Events::UPDATE,
+            "RENDER", (EventID)Events::RENDER,
+            "START", (EventID)Events::START,
+            "STOP", (EventID)Events::STOP)),
+        "LoadConfig", ScriptCommandBuffer::MainThreadOnly(&App::LoadConfig, "App:LoadConfig"),
+        "GetScene", &App::GetScene,
+        "GetUpdateRate", &App::GetUpdateRate,
+        "GetInterpolationAlpha", &App::GetInterpolationAlpha);
+
+    dusk.set_function("GetApp", &App::GetInst);
 }
 
 void App::GLFW_ErrorCallback(int code, const char * message)
@@ -329,6 +460,12 @@ void App::GLFW_KeyCallback(GLFWwindow* window, int key, int scancode, int action
     if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
         UI::ConsoleShown ^= 1;
 
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+        UI::RenderStatsShown ^= 1;
+
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+        UI::ProfilerShown ^= 1;
+
     ImGui_ImplGlfwGL3_KeyCallback(window, key, scancode, action, mods);
 }
 
@@ -339,23 +476,30 @@ void App::GLFW_CharCallback(GLFWwindow* window, unsigned int c)
 
 int UpdateEventData::PushToLua(lua_State * L) const
 {
-    lua_newtable(L);
+    // Every listener gets the same table, filled in place so UPDATE doesn't
+    // create garbage each frame. Scripts shouldn't hold on to it
+    static const char TABLE_KEY = 0;
+
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &TABLE_KEY);
+    if (!lua_istable(L, -1))
+    {
+        lua_pop(L, 1);
+        lua_createtable(L, 0, 4);
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &TABLE_KEY);
+    }
 
-    lua_pushstring(L, "Delta");
     lua_pushnumber(L, _delta);
-    lua_settable(L, -3);
+    lua_setfield(L, -2, "Delta");
 
-    lua_pushstring(L, "ElapsedTime");
     lua_pushnumber(L, _elapsed_time);
-    lua_settable(L, -3);
+    lua_setfield(L, -2, "ElapsedTime");
 
-    lua_pushstring(L, "TotalTime");
     lua_pushnumber(L, _total_time);
-    lua_settable(L, -3);
+    lua_setfield(L, -2, "TotalTime");
 
-    lua_pushstring(L, "CurrentFPS");
     lua_pushnumber(L, _current_fps);
-    lua_settable(L, -3);
+    lua_setfield(L, -2, "CurrentFPS");
 
     return 1;
 }
@@ -364,7 +508,8 @@ void UpdateEventData::Update(double elapsed)
 {
     _elapsed_time = elapsed;
     _total_time += elapsed;
-    _delta = (float)(elapsed / (1000.0f / _target_fps));
+    // 1.0 is exactly one update step, or one frame at the target rate
+    _delta = (float)(elapsed * _delta_rate);
 }
 
 } // namespace dusk
@@ -0,0 +1,108 @@
+#include "dusk/Asset.hpp"
+
+#include <dusk/Log.hpp>
+
+#include <chrono>
+
+namespace dusk {
+
+AssetLoader::AssetLoader(unsigned int threadCount /*= ThreadPool::GetDefaultLoaderThreadCount()*/)
+    : _completed(1024)
+    , _pool(threadCount)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    // Keep the completed queue moving so no worker is left waiting on it
+    // while the pool shuts down; nothing can be uploaded at this point
+    while (_pendingCount > 0)
+    {
+        if (_completed.TryPop([](Completed& completed) { completed.asset.reset(); }))
+        {
+            --_pendingCount;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void AssetLoader::Queue(std::shared_ptr<ILoadable> asset)
+{
+    ++_pendingCount;
+
+    // Jobs run inline without workers, and the main thread can't wait on
+    // itself to drain the queue
+    bool runsInline = (0 == _pool.GetThreadCount());
+
+    std::weak_ptr<ILoadable> weak = asset;
+    _pool.Submit([this, weak, runsInline]() {
+        bool loaded = false;
+
+        // Skip assets that were purged before we got to them
+        std::shared_ptr<ILoadable> ptr = weak.lock();
+        if (ptr)
+        {
+            loaded = ptr->Load();
+        }
+
+        auto fill = [&ptr, loaded](Completed& item) {
+            item.asset = std::move(ptr);
+            item.loaded = loaded;
+        };
+
+        if (!runsInline)
+        {
+            _completed.Push(fill);
+        }
+        else if (!_completed.TryPush(fill))
+        {
+            --_pendingCount;
+
+            if (ptr && loaded)
+            {
+                ptr->Upload();
+            }
+        }
+    });
+}
+
+void AssetLoader::ProcessCompleted(double budgetMs /*= 4.0*/)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    while (true)
+    {
+        Completed item;
+
+        bool popped = _completed.TryPop([&item](Completed& completed) {
+            item.asset = std::move(completed.asset);
+            item.loaded = completed.loaded;
+        });
+
+        if (!popped)
+        {
+            break;
+        }
+
+        --_pendingCount;
+
+        // Nobody else wants it any more, don't bother uploading
+        if (item.asset && item.loaded && item.asset.use_count() > 1)
+        {
+            item.asset->Upload();
+        }
+        item.asset.reset();
+
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+        if (elapsed.count() >= budgetMs)
+        {
+            break;
+        }
+    }
+}
+
+} // namespace dusk
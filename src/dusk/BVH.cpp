@@ -0,0 +1,574 @@
+#include "dusk/BVH.hpp"
+
+#include <dusk/Log.hpp>
+#include <algorithm>
+
+namespace dusk {
+
+// QueryRadius() and Raycast() may run on several threads at once, each
+// needs its own traversal stack
+static thread_local std::vector<int> _QueryStack;
+
+const int BVH::NULL_NODE;
+
+BVH::BVH()
+    : _nodes()
+    , _root(NULL_NODE)
+    , _freeList(NULL_NODE)
+    , _leafCount(0)
+{
+}
+
+BVH::~BVH()
+{
+}
+
+int BVH::Insert(const AABB& bounds, void * userData)
+{
+    int proxy = AllocateNode();
+
+    // Fatten by a tenth of the size so jittering objects stay put
+    glm::vec3 margin = bounds.GetExtents() * 0.1f + glm::vec3(0.1f);
+
+    Node& node = _nodes[proxy];
+    node.bounds.min = bounds.min - margin;
+    node.bounds.max = bounds.max + margin;
+    node.tight = bounds;
+    node.userData = userData;
+    node.height = 0;
+
+    InsertLeaf(proxy);
+    ++_leafCount;
+
+    return proxy;
+}
+
+void BVH::Remove(int proxy)
+{
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --_leafCount;
+}
+
+bool BVH::Move(int proxy, const AABB& bounds)
+{
+    _nodes[proxy].tight = bounds;
+
+    const AABB& fat = _nodes[proxy].bounds;
+    if (fat.min.x <= bounds.min.x && fat.min.y <= bounds.min.y && fat.min.z <= bounds.min.z &&
+        fat.max.x >= bounds.max.x && fat.max.y >= bounds.max.y && fat.max.z >= bounds.max.z)
+    {
+        return false;
+    }
+
+    RemoveLeaf(proxy);
+
+    glm::vec3 margin = bounds.GetExtents() * 0.1f + glm::vec3(0.1f);
+    _nodes[proxy].bounds.min = bounds.min - margin;
+    _nodes[proxy].bounds.max = bounds.max + margin;
+
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+void BVH::QueryFrustum(const Frustum& frustum, std::vector<void *>& results)
+{
+    if (NULL_NODE == _root)
+    {
+        return;
+    }
+
+    _candidates.clear();
+
+    _stack.clear();
+    _stack.push_back(_root);
+
+    while (!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Node& node = _nodes[index];
+
+        if (node.IsLeaf())
+        {
+            _candidates.push_back(index);
+            continue;
+        }
+
+        Frustum::Result result = frustum.TestAABB(node.bounds);
+        if (Frustum::OUTSIDE == result)
+        {
+            continue;
+        }
+
+        if (Frustum::INSIDE == result)
+        {
+            CollectLeaves(index, results);
+            continue;
+        }
+
+        _stack.push_back(node.left);
+        _stack.push_back(node.right);
+    }
+
+    size_t count = _candidates.size();
+
+    _candX.resize(count);
+    _candY.resize(count);
+    _candZ.resize(count);
+    _candRadius.resize(count);
+    _candVisible.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const AABB& bounds = _nodes[_candidates[i]].tight;
+        glm::vec3 center = bounds.GetCenter();
+
+        _candX[i] = center.x;
+        _candY[i] = center.y;
+        _candZ[i] = center.z;
+        _candRadius[i] = glm::length(bounds.GetExtents());
+    }
+
+    frustum.TestSpheres(_candX.data(), _candY.data(), _candZ.data(), _candRadius.data(),
+                        count, _candVisible.data());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_candVisible[i])
+        {
+            results.push_back(_nodes[_candidates[i]].userData);
+        }
+    }
+}
+
+void BVH::QueryRadius(const glm::vec3& center, float radius, std::vector<void *>& results) const
+{
+    if (NULL_NODE == _root)
+    {
+        return;
+    }
+
+    float radiusSq = radius * radius;
+
+    std::vector<int>& stack = _QueryStack;
+    stack.clear();
+    stack.push_back(_root);
+
+    while (!stack.empty())
+    {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+
+        const AABB& bounds = (node.IsLeaf() ? node.tight : node.bounds);
+
+        // Squared distance from the center to the closest point in the box
+        glm::vec3 closest = glm::min(glm::max(center, bounds.min), bounds.max);
+        glm::vec3 offset = closest - center;
+        if (glm::dot(offset, offset) > radiusSq)
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            results.push_back(node.userData);
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void * BVH::Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, float * hitDist /*= nullptr*/) const
+{
+    if (NULL_NODE == _root)
+    {
+        return nullptr;
+    }
+
+    glm::vec3 invDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+
+    void * hit = nullptr;
+    float nearest = maxDist;
+
+    std::vector<int>& stack = _QueryStack;
+    stack.clear();
+    stack.push_back(_root);
+
+    while (!stack.empty())
+    {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+
+        // Skipped when the box starts beyond the nearest hit so far
+        float t;
+        if (!IntersectRay((node.IsLeaf() ? node.tight : node.bounds), origin, invDir, nearest, t))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            hit = node.userData;
+            nearest = t;
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+
+    if (hit && hitDist)
+    {
+        *hitDist = nearest;
+    }
+
+    return hit;
+}
+
+int BVH::AllocateNode()
+{
+    if (NULL_NODE == _freeList)
+    {
+        _nodes.emplace_back();
+        _nodes.back().height = -1;
+        _freeList = (int)_nodes.size() - 1;
+        _nodes.back().parent = NULL_NODE;
+    }
+
+    int index = _freeList;
+    Node& node = _nodes[index];
+    _freeList = node.parent;
+
+    node.parent = NULL_NODE;
+    node.left = NULL_NODE;
+    node.right = NULL_NODE;
+    node.height = 0;
+    node.userData = nullptr;
+
+    return index;
+}
+
+void BVH::FreeNode(int node)
+{
+    _nodes[node].parent = _freeList;
+    _nodes[node].height = -1;
+    _freeList = node;
+}
+
+void BVH::InsertLeaf(int leaf)
+{
+    if (NULL_NODE == _root)
+    {
+        _root = leaf;
+        _nodes[_root].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down picking the child that grows the least in surface area
+    const AABB leafBounds = _nodes[leaf].bounds;
+    int index = _root;
+
+    while (!_nodes[index].IsLeaf())
+    {
+        int left = _nodes[index].left;
+        int right = _nodes[index].right;
+
+        float area = SurfaceArea(_nodes[index].bounds);
+        float combinedArea = SurfaceArea(Union(_nodes[index].bounds, leafBounds));
+
+        // Cost of a new parent here, and the cost pushed down to the children
+        float cost = 2.0f * combinedArea;
+        float inheritCost = 2.0f * (combinedArea - area);
+
+        float leftCost = SurfaceArea(Union(leafBounds, _nodes[left].bounds)) + inheritCost;
+        if (!_nodes[left].IsLeaf())
+        {
+            leftCost -= SurfaceArea(_nodes[left].bounds);
+        }
+
+        float rightCost = SurfaceArea(Union(leafBounds, _nodes[right].bounds)) + inheritCost;
+        if (!_nodes[right].IsLeaf())
+        {
+            rightCost -= SurfaceArea(_nodes[right].bounds);
+        }
+
+        if (cost < leftCost && cost < rightCost)
+        {
+            break;
+        }
+
+        index = (leftCost < rightCost ? left : right);
+    }
+
+    int sibling = index;
+    int oldParent = _nodes[sibling].parent;
+
+    int newParent = AllocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].bounds = Union(leafBounds, _nodes[sibling].bounds);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].left = sibling;
+    _nodes[newParent].right = leaf;
+
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (NULL_NODE == oldParent)
+    {
+        _root = newParent;
+    }
+    else if (_nodes[oldParent].left == sibling)
+    {
+        _nodes[oldParent].left = newParent;
+    }
+    else
+    {
+        _nodes[oldParent].right = newParent;
+    }
+
+    // Refit and rebalance back up to the root
+    index = _nodes[leaf].parent;
+    while (NULL_NODE != index)
+    {
+        index = Balance(index);
+
+        int left = _nodes[index].left;
+        int right = _nodes[index].right;
+
+        _nodes[index].height = 1 + std::max(_nodes[left].height, _nodes[right].height);
+        _nodes[index].bounds = Union(_nodes[left].bounds, _nodes[right].bounds);
+
+        index = _nodes[index].parent;
+    }
+}
+
+void BVH::RemoveLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_NODE;
+        return;
+    }
+
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = (_nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left);
+
+    if (NULL_NODE == grandParent)
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+        return;
+    }
+
+    if (_nodes[grandParent].left == parent)
+    {
+        _nodes[grandParent].left = sibling;
+    }
+    else
+    {
+        _nodes[grandParent].right = sibling;
+    }
+    _nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    int index = grandParent;
+    while (NULL_NODE != index)
+    {
+        index = Balance(index);
+
+        int left = _nodes[index].left;
+        int right = _nodes[index].right;
+
+        _nodes[index].bounds = Union(_nodes[left].bounds, _nodes[right].bounds);
+        _nodes[index].height = 1 + std::max(_nodes[left].height, _nodes[right].height);
+
+        index = _nodes[index].parent;
+    }
+}
+
+int BVH::Balance(int iA)
+{
+    Node * A = &_nodes[iA];
+    if (A->IsLeaf() || A->height < 2)
+    {
+        return iA;
+    }
+
+    int iB = A->left;
+    int iC = A->right;
+    Node * B = &_nodes[iB];
+    Node * C = &_nodes[iC];
+
+    int balance = C->height - B->height;
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        int iF = C->left;
+        int iG = C->right;
+        Node * F = &_nodes[iF];
+        Node * G = &_nodes[iG];
+
+        C->left = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+
+        if (NULL_NODE == C->parent)
+        {
+            _root = iC;
+        }
+        else if (_nodes[C->parent].left == iA)
+        {
+            _nodes[C->parent].left = iC;
+        }
+        else
+        {
+            _nodes[C->parent].right = iC;
+        }
+
+        if (F->height > G->height)
+        {
+            C->right = iF;
+            A->right = iG;
+            G->parent = iA;
+            A->bounds = Union(B->bounds, G->bounds);
+            C->bounds = Union(A->bounds, F->bounds);
+
+            A->height = 1 + std::max(B->height, G->height);
+            C->height = 1 + std::max(A->height, F->height);
+        }
+        else
+        {
+            C->right = iG;
+            A->right = iF;
+            F->parent = iA;
+            A->bounds = Union(B->bounds, F->bounds);
+            C->bounds = Union(A->bounds, G->bounds);
+
+            A->height = 1 + std::max(B->height, F->height);
+            C->height = 1 + std::max(A->height, G->height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        int iD = B->left;
+        int iE = B->right;
+        Node * D = &_nodes[iD];
+        Node * E = &_nodes[iE];
+
+        B->left = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+
+        if (NULL_NODE == B->parent)
+        {
+            _root = iB;
+        }
+        else if (_nodes[B->parent].left == iA)
+        {
+            _nodes[B->parent].left = iB;
+        }
+        else
+        {
+            _nodes[B->parent].right = iB;
+        }
+
+        if (D->height > E->height)
+        {
+            B->right = iD;
+            A->left = iE;
+            E->parent = iA;
+            A->bounds = Union(C->bounds, E->bounds);
+            B->bounds = Union(A->bounds, D->bounds);
+
+            A->height = 1 + std::max(C->height, E->height);
+            B->height = 1 + std::max(A->height, D->height);
+        }
+        else
+        {
+            B->right = iE;
+            A->left = iD;
+            D->parent = iA;
+            A->bounds = Union(C->bounds, D->bounds);
+            B->bounds = Union(A->bounds, E->bounds);
+
+            A->height = 1 + std::max(C->height, D->height);
+            B->height = 1 + std::max(A->height, E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+void BVH::CollectLeaves(int node, std::vector<void *>& results) const
+{
+    // Runs inside QueryFrustum's traversal, so it needs its own stack
+    std::vector<int>& stack = _collectStack;
+    stack.clear();
+    stack.push_back(node);
+
+    while (!stack.empty())
+    {
+        const Node& current = _nodes[stack.back()];
+        stack.pop_back();
+
+        if (current.IsLeaf())
+        {
+            results.push_back(current.userData);
+        }
+        else
+        {
+            stack.push_back(current.left);
+            stack.push_back(current.right);
+        }
+    }
+}
+
+bool BVH::IntersectRay(const AABB& bounds, const glm::vec3& origin, const glm::vec3& invDir,
+                       float maxDist, float& t)
+{
+    float tmin = 0.0f;
+    float tmax = maxDist;
+    for (int i = 0; i < 3; ++i)
+    {
+        float t1 = (bounds.min[i] - origin[i]) * invDir[i];
+        float t2 = (bounds.max[i] - origin[i]) * invDir[i];
+
+        tmin = std::max(tmin, std::min(t1, t2));
+        tmax = std::min(tmax, std::max(t1, t2));
+    }
+
+    t = tmin;
+    return (tmin <= tmax);
+}
+
+float BVH::SurfaceArea(const AABB& bounds)
+{
+    glm::vec3 size = bounds.max - bounds.min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+AABB BVH::Union(const AABB& lhs, const AABB& rhs)
+{
+    AABB result;
+    result.min = glm::min(lhs.min, rhs.min);
+    result.max = glm::max(lhs.max, rhs.max);
+    return result;
+}
+
+} // namespace dusk
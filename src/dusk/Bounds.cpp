@@ -0,0 +1,160 @@
+#include "dusk/Bounds.hpp"
+
+namespace dusk {
+
+AABB AABB::Transform(const glm::mat4& transform) const
+{
+    if (!IsValid())
+    {
+        return AABB();
+    }
+
+    glm::vec3 center = GetCenter();
+    glm::vec3 extents = GetExtents();
+
+    glm::vec4 worldCenter = transform * glm::vec4(center, 1.0f);
+    glm::vec3 worldExtents;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        worldExtents[i] = std::fabs(transform[0][i]) * extents.x
+                        + std::fabs(transform[1][i]) * extents.y
+                        + std::fabs(transform[2][i]) * extents.z;
+    }
+
+    AABB result;
+    result.min = glm::vec3(worldCenter.x, worldCenter.y, worldCenter.z) - worldExtents;
+    result.max = glm::vec3(worldCenter.x, worldCenter.y, worldCenter.z) + worldExtents;
+    return result;
+}
+
+void BoundingSphere::Expand(const BoundingSphere& other)
+{
+    if (!other.IsValid())
+    {
+        return;
+    }
+
+    if (!IsValid())
+    {
+        *this = other;
+        return;
+    }
+
+    glm::vec3 offset = other.center - center;
+    float dist = glm::length(offset);
+
+    if (dist + other.radius <= radius)
+    {
+        return;
+    }
+
+    if (dist + radius <= other.radius)
+    {
+        *this = other;
+        return;
+    }
+
+    float newRadius = (dist + radius + other.radius) * 0.5f;
+    center = center + offset * ((newRadius - radius) / dist);
+    radius = newRadius;
+}
+
+BoundingSphere BoundingSphere::Transform(const glm::mat4& transform) const
+{
+    if (!IsValid())
+    {
+        return BoundingSphere();
+    }
+
+    glm::vec4 worldCenter = transform * glm::vec4(center, 1.0f);
+
+    // Non-uniform scale stretches the sphere by its largest axis
+    float scale = std::fmax(glm::length(glm::vec3(transform[0].x, transform[0].y, transform[0].z)),
+                  std::fmax(glm::length(glm::vec3(transform[1].x, transform[1].y, transform[1].z)),
+                            glm::length(glm::vec3(transform[2].x, transform[2].y, transform[2].z))));
+
+    BoundingSphere result;
+    result.center = glm::vec3(worldCenter.x, worldCenter.y, worldCenter.z);
+    result.radius = radius * scale;
+    return result;
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProj)
+{
+    Frustum frustum;
+
+    // Gribb/Hartmann, glm is column major so rows are gathered by hand
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[3] + rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+
+    for (glm::vec4& plane : frustum.planes)
+    {
+        float len = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        if (len > 0.0f)
+        {
+            plane = plane * (1.0f / len);
+        }
+    }
+
+    return frustum;
+}
+
+Frustum::Result Frustum::TestAABB(const AABB& bounds) const
+{
+    glm::vec3 center = bounds.GetCenter();
+    glm::vec3 extents = bounds.GetExtents();
+
+    Result result = INSIDE;
+    for (const glm::vec4& plane : planes)
+    {
+        float dist = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        float reach = std::fabs(plane.x) * extents.x
+                    + std::fabs(plane.y) * extents.y
+                    + std::fabs(plane.z) * extents.z;
+
+        if (dist + reach < 0.0f)
+        {
+            return OUTSIDE;
+        }
+
+        if (dist - reach < 0.0f)
+        {
+            result = INTERSECT;
+        }
+    }
+
+    return result;
+}
+
+void Frustum::TestSpheres(const float * x, const float * y, const float * z, const float * radius,
+                          size_t count, unsigned char * visible) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        visible[i] = 1;
+    }
+
+    for (const glm::vec4& plane : planes)
+    {
+        const float px = plane.x, py = plane.y, pz = plane.z, pw = plane.w;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            float dist = px * x[i] + py * y[i] + pz * z[i] + pw;
+            visible[i] &= (unsigned char)(dist >= -radius[i]);
+        }
+    }
+}
+
+} // namespace dusk
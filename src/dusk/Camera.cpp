@@ -2,6 +2,8 @@
 
 #include <dusk/Log.hpp>
 #include <dusk/App.hpp>
+#include <dusk/ScriptHost.hpp>
+#include <dusk/ScriptCommandBuffer.hpp>
 
 namespace dusk {
 
@@ -15,6 +17,8 @@ Camera::Camera(float fov /*= 45.0f*/, glm::vec3 up /*= glm::vec3(0, 1, 0)*/, glm
     , _aspect()
     , _clip(clip)
     , _position(0)
+    , _previousPosition(0)
+    , _renderPosition(0)
     , _forward(1)
     , _up(up)
     , _friction(0.9f)
@@ -90,7 +94,7 @@ glm::mat4 Camera::GetView()
 {
     if (_viewInvalid)
     {
-        _view = glm::lookAt(_position, _position + _forward, _up) * _baseTransform;
+        _view = glm::lookAt(_renderPosition, _renderPosition + _forward, _up) * _baseTransform;
         _viewInvalid = false;
     }
     return _view;
@@ -126,8 +130,11 @@ void Camera::SetClip(const glm::vec2& clip)
 
 void Camera::SetPosition(const glm::vec3& pos)
 {
+    // Moves straight there, nothing to blend from
     _position = pos;
-    _projectionInvalid = true;
+    _previousPosition = pos;
+    _renderPosition = pos;
+    _viewInvalid = true;
 }
 
 void Camera::SetForward(const glm::vec3& forward)
@@ -149,6 +156,8 @@ void Camera::AddVelocity(const glm::vec3& vel)
 
 void Camera::Update()
 {
+    _previousPosition = _position;
+
     if (_velocity == glm::vec3(0))
     {
         return;
@@ -169,4 +178,39 @@ void Camera::Update()
         _velocity.z = 0.0f;
 }
 
+void Camera::Interpolate(float alpha)
+{
+    glm::vec3 position = glm::mix(_previousPosition, _position, alpha);
+    if (position != _renderPosition)
+    {
+        _renderPosition = position;
+        _viewInvalid = true;
+    }
+}
+
+void Camera::InitScripting()
+{
+    ScriptHost::AddBinding(&Camera::BindScripting);
+}
+
+void Camera::BindScripting(lua_State * L)
+{
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    dusk.new_usertype<Camera>("Camera",
+        "new", sol::no_constructor,
+        "GetFOV", &Camera::GetFOV,
+        "SetFOV", ScriptCommandBuffer::MainThreadOnly(&Camera::SetFOV, "Camera:SetFOV"),
+        "GetAspect", &Camera::GetAspect,
+        "SetAspect", ScriptCommandBuffer::MainThreadOnly(sol::resolve<void(float)>(&Camera::SetAspect), "Camera:SetAspect"),
+        "GetPosition", &Camera::GetPosition,
+        "SetPosition", ScriptCommandBuffer::MainThreadOnly(&Camera::SetPosition, "Camera:SetPosition"),
+        "GetForward", &Camera::GetForward,
+        "SetForward", ScriptCommandBuffer::MainThreadOnly(&Camera::SetForward, "Camera:SetForward"),
+        "GetUp", &Camera::GetUp,
+        "SetUp", ScriptCommandBuffer::MainThreadOnly(&Camera::SetUp, "Camera:SetUp"),
+        "AddVelocity", ScriptCommandBuffer::MainThreadOnly(&Camera::AddVelocity, "Camera:AddVelocity"));
+}
+
 } // namespace dusk
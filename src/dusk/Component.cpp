@@ -3,12 +3,14 @@
 #include <dusk/Log.hpp>
 #include <dusk/App.hpp>
 #include <dusk/Actor.hpp>
+#include <dusk/Scene.hpp>
 
 namespace dusk {
 
 Component::Component(bool isTempalte /*= false*/)
     : _actor(nullptr)
     , _isTemplate(isTempalte)
+    , _poolIndex(ComponentPool<Component>::INVALID_INDEX)
 {
 }
 
@@ -31,7 +33,13 @@ std::unique_ptr<Component> Component::Parse(nlohmann::json & data, bool isTempla
 	}
 	else if ("Script" == type)
 	{
-		component.reset(new ScriptComponent(data["File"].get<std::string>(), isTemplate));
+		bool isParallel = false;
+		if (data.find("Parallel") != data.end())
+		{
+			isParallel = data["Parallel"];
+		}
+
+		component.reset(new ScriptComponent(data["File"].get<std::string>(), isTemplate, isParallel));
 	}
 
 	return component;
@@ -53,20 +61,35 @@ void Component::SetActor(Actor * actor)
 
 void Component::InitScripting()
 {
-    ScriptHost::AddFunction("dusk_Component_GetActor", &Component::Script_GetActor);
+    ScriptHost::AddBinding(&Component::BindScripting);
 
     //ModelComponent::InitScripting();
     //CameraComponent::InitScripting();
     //ScriptComponent::InitScripting();
 }
 
-int Component::Script_GetActor(lua_State * L)
+void Component::BindScripting(lua_State * L)
 {
-    Component * componenet = (Component *)lua_tointeger(L, 1);
-
-    lua_pushinteger(L, (ptrdiff_t)componenet->GetActor());
-
-    return 1;
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    dusk.new_usertype<Component>("Component",
+        "new", sol::no_constructor,
+        "GetActor", &Component::GetActor);
+
+    dusk.new_usertype<CameraComponent>("CameraComponent",
+        "new", sol::no_constructor,
+        sol::base_classes, sol::bases<Component>(),
+        "GetCamera", &CameraComponent::GetCamera);
+
+    dusk.set_function("GetComponent", [](sol::this_state L) {
+        // Script components share one state, so this lives in the running script's environment
+        ScriptHost::PushGlobal(L, "dusk_current_ScriptComponent");
+        Component * component = (Component *)lua_tointeger(L, -1);
+        lua_pop(L, 1);
+
+        return component;
+    });
 }
 
 ModelComponent::ModelComponent(std::unique_ptr<Model> model, bool isTempalte /*= false*/)
@@ -77,11 +100,6 @@ ModelComponent::ModelComponent(std::unique_ptr<Model> model, bool isTempalte /*=
 
 ModelComponent::~ModelComponent()
 {
-    if (GetActor() && !IsTemplate())
-    {
-        GetActor()->RemoveEventListener((EventID)Actor::Events::UPDATE, this, &ModelComponent::OnUpdate);
-        GetActor()->RemoveEventListener((EventID)Actor::Events::RENDER, this, &ModelComponent::OnRender);
-    }
 }
 
 std::unique_ptr<Component> ModelComponent::Clone()
@@ -95,30 +113,44 @@ std::unique_ptr<Component> ModelComponent::Clone()
 
 void ModelComponent::SetActor(Actor * actor)
 {
-    if (GetActor() && !IsTemplate())
-    {
-        GetActor()->RemoveEventListener((EventID)Actor::Events::UPDATE, this, &ModelComponent::OnUpdate);
-        GetActor()->RemoveEventListener((EventID)Actor::Events::RENDER, this, &ModelComponent::OnRender);
-    }
-
     Component::SetActor(actor);
 
+    _model->SetParentTransform(actor->GetTransformHandle());
+}
+
+void ModelComponent::AddToScene(Scene * scene)
+{
     if (!IsTemplate())
     {
-        GetActor()->AddEventListener((EventID)Actor::Events::UPDATE, this, &ModelComponent::OnUpdate);
-        GetActor()->AddEventListener((EventID)Actor::Events::RENDER, this, &ModelComponent::OnRender);
+        scene->GetModelComponents().Add(this);
     }
 }
 
+void ModelComponent::RemoveFromScene(Scene * scene)
+{
+    scene->GetModelComponents().Remove(this);
+}
+
+void ModelComponent::ExpandBounds(AABB& bounds)
+{
+    _model->UpdateBounds();
+    bounds.Expand(_model->GetWorldBounds());
+}
+
 void ModelComponent::OnUpdate(const Event& event)
 {
-    _model->SetBaseTransform(GetActor()->GetTransform());
     _model->Update();
+
+    // Meshes that are still loading have no bounds, keep asking until they do
+    if (!_model->GetWorldBounds().IsValid())
+    {
+        GetActor()->UpdateBounds();
+    }
 }
 
 void ModelComponent::OnRender(const Event& event)
 {
-    _model->Render();
+    _model->Render(GetActor()->GetScene()->GetRenderQueue());
 }
 
 CameraComponent::CameraComponent(std::unique_ptr<Camera> camera, bool isTempalte /*= false*/)
@@ -129,10 +161,6 @@ CameraComponent::CameraComponent(std::unique_ptr<Camera> camera, bool isTempalte
 
 CameraComponent::~CameraComponent()
 {
-    if (GetActor() && !IsTemplate())
-    {
-        GetActor()->RemoveEventListener((EventID)Actor::Events::UPDATE, this, &CameraComponent::OnUpdate);
-    }
 }
 
 std::unique_ptr<Component> CameraComponent::Clone()
@@ -146,40 +174,47 @@ std::unique_ptr<Component> CameraComponent::Clone()
 
 void CameraComponent::SetActor(Actor * actor)
 {
-    if (GetActor() && !IsTemplate())
-    {
-        GetActor()->RemoveEventListener((EventID)Actor::Events::UPDATE, this, &CameraComponent::OnUpdate);
-    }
-
     Component::SetActor(actor);
+}
 
+void CameraComponent::AddToScene(Scene * scene)
+{
     if (!IsTemplate())
     {
-        GetActor()->AddEventListener((EventID)Actor::Events::UPDATE, this, &CameraComponent::OnUpdate);
+        scene->GetCameraComponents().Add(this);
     }
 }
 
+void CameraComponent::RemoveFromScene(Scene * scene)
+{
+    scene->GetCameraComponents().Remove(this);
+}
+
 void CameraComponent::OnUpdate(const Event& event)
 {
     _camera->SetBaseTransform(glm::inverse(GetActor()->GetTransform()));
 }
 
-ScriptComponent::ScriptComponent(const std::string& filename, bool isTempalte /*= false*/)
+void CameraComponent::OnPreRender(const Event& event)
+{
+    TransformPool * transformPool = App::GetInst()->GetTransformPool();
+    _camera->SetBaseTransform(glm::inverse(transformPool->GetRenderWorld(GetActor()->GetTransformHandle())));
+}
+
+ScriptComponent::ScriptComponent(const std::string& filename, bool isTempalte /*= false*/, bool isParallel /*= false*/)
     : Component(isTempalte)
-    , _scriptHost()
+    , _scriptHost(!isParallel)
     , _filename(filename)
+    , _isParallel(isParallel)
 {
-    lua_State * L = _scriptHost.GetLuaState();
-
-    lua_pushinteger(L, (ptrdiff_t)this);
-    lua_setglobal(L, "dusk_current_ScriptComponent");
+    _scriptHost.SetGlobal("dusk_current_ScriptComponent", (ptrdiff_t)this);
 
     // Wait until we have an actor to run the script
 }
 
 std::unique_ptr<Component> ScriptComponent::Clone()
 {
-    ScriptComponent * component = new ScriptComponent(_filename);
+    ScriptComponent * component = new ScriptComponent(_filename, false, _isParallel);
 
     component->SetActor(GetActor());
 
@@ -199,7 +234,54 @@ void ScriptComponent::SetActor(Actor * actor)
     {
         // TODO: Fix
         _scriptHost.RunFile(_filename);
+
+        if (IsParallel())
+        {
+            lua_State * L = _scriptHost.GetLuaState();
+
+            lua_getglobal(L, "OnUpdate");
+            if (!lua_isfunction(L, -1))
+            {
+                DuskLogWarn("Parallel script '%s' has no OnUpdate function", _filename.c_str());
+            }
+            lua_pop(L, 1);
+
+            // By name, so a reloaded script's OnUpdate replaces the old one
+            lua_pushstring(L, "OnUpdate");
+            _onUpdate.reset(new LuaEventCallback(L, -1));
+            lua_pop(L, 1);
+        }
+    }
+}
+
+void ScriptComponent::AddToScene(Scene * scene)
+{
+    if (!IsTemplate() && IsParallel())
+    {
+        scene->GetParallelScripts().Add(this);
+    }
+}
+
+void ScriptComponent::RemoveFromScene(Scene * scene)
+{
+    scene->GetParallelScripts().Remove(this);
+}
+
+void ScriptComponent::OnParallelUpdate(const Event& event)
+{
+    if (!_onUpdate)
+    {
+        return;
     }
+
+    ScriptCommandBuffer::SetCurrent(&_commands);
+    _onUpdate->Invoke(event);
+    ScriptCommandBuffer::SetCurrent(nullptr);
+}
+
+void ScriptComponent::FlushCommands()
+{
+    _commands.Flush(App::GetInst()->GetTransformPool());
 }
 
 } // namespace dusk
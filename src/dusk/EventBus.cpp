@@ -0,0 +1,50 @@
+#include "dusk/EventBus.hpp"
+
+#include <dusk/EventDispatcher.hpp>
+#include <dusk/Log.hpp>
+
+namespace dusk {
+
+EventBus::EventBus(size_t capacity /*= 4096*/)
+    : _queue(capacity)
+    , _consumerThread(std::this_thread::get_id())
+{
+}
+
+EventBus::~EventBus()
+{
+    // Destroy payloads that were never delivered
+    while (_queue.TryPop([](Message& message) {
+        if (message.destroy)
+        {
+            message.destroy(message.data);
+        }
+    }))
+    { }
+}
+
+size_t EventBus::Dispatch(size_t maxEvents /*= (size_t)-1*/)
+{
+    size_t count = 0;
+
+    while (count < maxEvents && _queue.TryPop([](Message& message) {
+        message.target->DispatchEvent(Event(message.eventId, *message.data));
+
+        if (message.destroy)
+        {
+            message.destroy(message.data);
+        }
+    }))
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+void EventBus::WarnDropped(const EventID& eventId)
+{
+    DuskLogWarn("Event bus is full, dropping event %u posted from the main thread", eventId);
+}
+
+} // namespace dusk
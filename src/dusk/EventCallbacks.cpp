@@ -1,16 +1,140 @@
 #include "dusk/EventCallbacks.hpp"
 
+#include <dusk/EventDelegate.hpp>
 #include <dusk/Log.hpp>
+#include <dusk/ScriptProfiler.hpp>
 
 namespace dusk {
 
+LuaEventCallback::LuaEventCallback(lua_State * luaState, int index, int envRef /*= LUA_NOREF*/)
+    : _luaState(luaState)
+    , _stateSerial(ScriptHost::GetStateSerial(luaState))
+    , _funcName()
+    , _funcPtr(nullptr)
+    , _funcRef(LUA_NOREF)
+    , _envRef(envRef)
+    , _reloadSerial(ScriptHost::GetReloadSerial())
+    , _reported(false)
+{
+    if (lua_isfunction(_luaState, index))
+    {
+        _funcPtr = lua_topointer(_luaState, index);
+        _label = ScriptHost::DescribeFunction(_luaState, index, "listener");
+
+        lua_pushvalue(_luaState, index);
+        _funcRef = luaL_ref(_luaState, LUA_REGISTRYINDEX);
+        return;
+    }
+
+    if (lua_isstring(_luaState, index))
+    {
+        _funcName = lua_tostring(_luaState, index);
+    }
+}
+
+LuaEventCallback::~LuaEventCallback()
+{
+    // The state may have been closed before its listeners were removed
+    if (LUA_NOREF != _funcRef && ScriptHost::GetStateSerial(_luaState) == _stateSerial)
+    {
+        luaL_unref(_luaState, LUA_REGISTRYINDEX, _funcRef);
+    }
+}
+
+bool LuaEventCallback::Resolve()
+{
+    // Look names up again after a reload, in case the function was replaced
+    if (!_funcName.empty() && _reloadSerial != ScriptHost::GetReloadSerial())
+    {
+        _reloadSerial = ScriptHost::GetReloadSerial();
+
+        luaL_unref(_luaState, LUA_REGISTRYINDEX, _funcRef);
+        _funcRef = LUA_NOREF;
+        _reported = false;
+    }
+
+    if (LUA_NOREF != _funcRef)
+    {
+        return true;
+    }
+
+    if (_funcName.empty())
+    {
+        return false;
+    }
+
+    int prevEnv = ScriptHost::GetCurrentEnv();
+    ScriptHost::SetCurrentEnv(_envRef);
+    ScriptHost::PushGlobal(_luaState, _funcName.c_str());
+    ScriptHost::SetCurrentEnv(prevEnv);
+
+    if (!lua_isfunction(_luaState, -1))
+    {
+        lua_pop(_luaState, 1);
+        return false;
+    }
+
+    _label = ScriptHost::DescribeFunction(_luaState, -1, _funcName.c_str());
+    _funcRef = luaL_ref(_luaState, LUA_REGISTRYINDEX);
+
+    return true;
+}
+
+bool LuaEventCallback::IsExpired() const
+{
+    return ScriptHost::GetStateSerial(_luaState) != _stateSerial
+        || !ScriptHost::IsEnvAlive(_envRef);
+}
+
 void LuaEventCallback::Invoke(const Event& event)
 {
-    lua_getglobal(_luaState, _funcName.c_str());
+    if (IsExpired())
+    {
+        return;
+    }
+
+    if (!Resolve())
+    {
+        if (!_reported)
+        {
+            DuskLogError("Lua event listener '%s' is not a function", _funcName.c_str());
+            _reported = true;
+        }
+        return;
+    }
+
+    int prevEnv = ScriptHost::GetCurrentEnv();
+    ScriptHost::SetCurrentEnv(_envRef);
+
+    lua_rawgeti(_luaState, LUA_REGISTRYINDEX, _funcRef);
 
     int argCount = event.PushDataToLua(_luaState);
 
-    lua_pcall(_luaState, argCount, 0, 0);
+    ScriptProfiler& profiler = ScriptHost::GetProfiler();
+
+    profiler.BeginCall(_label);
+    ScriptHost::Call(_luaState, argCount, 0);
+    profiler.EndCall();
+
+    ScriptHost::SetCurrentEnv(prevEnv);
+}
+
+EventDelegate EventDelegate::FromCallback(IEventCallback * callback)
+{
+    EventDelegate delegate;
+    delegate._object = callback;
+    delegate._invoke = &CallbackStub;
+    return delegate;
+}
+
+IEventCallback * EventDelegate::GetCallback() const
+{
+    return (&CallbackStub == _invoke ? static_cast<IEventCallback *>(_object) : nullptr);
+}
+
+void EventDelegate::CallbackStub(const EventDelegate& delegate, const Event& event)
+{
+    static_cast<IEventCallback *>(delegate._object)->Invoke(event);
 }
 
 } // namespace dusk
@@ -1,154 +1,278 @@
 #include "dusk/EventDispatcher.hpp"
 
 #include <dusk/Log.hpp>
-
-unsigned int balance = 0;
+#include <dusk/ScriptCommandBuffer.hpp>
 
 namespace dusk {
 
-void IEventDispatcher::AddEventListener(const EventID& eventId, IEventCallback * callback)
+EventListenerID IEventDispatcher::AddEventListener(const EventID& eventId, IEventCallback * callback)
+{
+    return AddListener(eventId, EventDelegate::FromCallback(callback));
+}
+
+void IEventDispatcher::RemoveEventListener(const EventID& eventId, const IEventCallback * callback)
 {
-    if (_eventListeners.find(eventId) == _eventListeners.end())
+    size_t index = FindList(eventId);
+    if (index == _listenerLists.size()) return;
+
+    ListenerList& list = _listenerLists[index];
+    for (Listener& listener : list.listeners)
     {
-        _eventListeners.emplace(eventId, std::vector<IEventCallback *>());
+        IEventCallback * owned = listener.delegate.GetCallback();
+        if (!listener.dead && owned && *owned == *callback)
+        {
+            KillListener(list, listener);
+            break;
+        }
     }
 
-    _eventListeners[eventId].push_back(callback);
+    Compact(false);
 }
 
-void IEventDispatcher::RemoveEventListener(const EventID& eventId, const IEventCallback * callback)
+EventListenerID IEventDispatcher::AddEventListener(const EventID& eventId, const EventDelegate& delegate)
 {
-    const auto& listIt = _eventListeners.find(eventId);
-    if (listIt == _eventListeners.end()) return;
+    return AddListener(eventId, delegate);
+}
 
-    auto& list = listIt->second;
+void IEventDispatcher::RemoveEventListener(const EventID& eventId, const EventDelegate& delegate)
+{
+    size_t index = FindList(eventId);
+    if (index == _listenerLists.size()) return;
 
-    if (_deadEventListeners.find(eventId) == _deadEventListeners.end())
+    ListenerList& list = _listenerLists[index];
+    for (Listener& listener : list.listeners)
     {
-        _deadEventListeners.emplace(eventId, std::vector<IEventCallback *>());
+        if (!listener.dead && listener.delegate == delegate)
+        {
+            KillListener(list, listener);
+            break;
+        }
     }
 
-    for (auto it = list.begin(); it != list.end(); ++it)
+    Compact(false);
+}
+
+void IEventDispatcher::RemoveEventListener(const EventListenerID& id)
+{
+    if (id.slot >= _slots.size() || _slots[id.slot].generation != id.generation)
     {
-        IEventCallback * tmp = *it;
-        if (*tmp == *callback)
-        {
-            _deadEventListeners[eventId].push_back(tmp);
-            return;
-        }
+        return;
     }
+
+    const Slot& slot = _slots[id.slot];
+    ListenerList& list = _listenerLists[slot.list];
+    KillListener(list, list.listeners[slot.index]);
+
+    Compact(false);
 }
 
 void IEventDispatcher::DispatchEvent(const Event& event)
 {
-    const auto& listIt = _eventListeners.find(event.GetID());
-    if (listIt == _eventListeners.end()) return;
+    size_t index = FindList(event.GetID());
+    if (index == _listenerLists.size()) return;
 
-    auto& list = listIt->second;
+    ++_dispatchDepth;
 
-    for (const auto& listener : list)
+    // Listeners may add to or remove from any list while we walk this one,
+    // so go through indices rather than holding references
+    size_t count = _listenerLists[index].listeners.size();
+    for (size_t i = 0; i < count; ++i)
     {
-        if (_deadEventListeners.find(event.GetID()) != _deadEventListeners.end())
+        Listener& listener = _listenerLists[index].listeners[i];
+        if (listener.dead)
         {
-            DuskLogWarn("Has dead events");
-            bool dead = false;
-            for (IEventCallback * callback : _deadEventListeners[event.GetID()])
-            {
-                if (listener == callback)
-                {
-                    DuskLogWarn("Is dead");
-                    dead = true;
-                    continue;
-                }
-            }
-            if (dead)
-                continue;
+            continue;
         }
-        listener->Invoke(event);
-    }
-
-    for (auto deadEventList : _deadEventListeners)
-    {
-        const EventID& eventId = deadEventList.first;
-        auto& deadList = deadEventList.second;
 
-        for (IEventCallback * deadCallback : deadList)
+        IEventCallback * callback = listener.delegate.GetCallback();
+        if (callback && callback->IsExpired())
         {
-            auto& eventList = _eventListeners[eventId];
-            for (auto it = eventList.begin(); it != eventList.end(); ++it)
-            {
-                if (*it == deadCallback)
-                {
-                    DuskLogWarn("Murder");
-                    delete deadCallback;
-                    std::swap(*it, eventList.back());
-                    eventList.pop_back();
-                    break;
-                }
-            }
+            KillListener(_listenerLists[index], listener);
+            continue;
         }
+
+        EventDelegate delegate = listener.delegate;
+        delegate(event);
     }
-    _deadEventListeners.clear();
+
+    --_dispatchDepth;
+
+    Compact(false);
 }
 
 void IEventDispatcher::RemoveAllEventListeners()
 {
-    for (auto it : _eventListeners)
+    for (ListenerList& list : _listenerLists)
     {
-        for (IEventCallback * callback : it.second)
+        for (Listener& listener : list.listeners)
         {
-            delete callback;
+            KillListener(list, listener);
         }
-        it.second.clear();
     }
-    _eventListeners.clear();
-    _deadEventListeners.clear();
+
+    Compact(true);
 }
 
 void IEventDispatcher::RemoveAllEventListeners(const EventID& eventId)
 {
-    const auto& listIt = _eventListeners.find(eventId);
-    if (listIt == _eventListeners.end()) return;
+    size_t index = FindList(eventId);
+    if (index == _listenerLists.size()) return;
+
+    ListenerList& list = _listenerLists[index];
+    for (Listener& listener : list.listeners)
+    {
+        KillListener(list, listener);
+    }
+
+    Compact(true);
+}
+
+size_t IEventDispatcher::FindList(const EventID& eventId) const
+{
+    for (size_t i = 0; i < _listenerLists.size(); ++i)
+    {
+        if (_listenerLists[i].eventId == eventId)
+        {
+            return i;
+        }
+    }
+    return _listenerLists.size();
+}
+
+EventListenerID IEventDispatcher::AddListener(const EventID& eventId, const EventDelegate& delegate)
+{
+    size_t index = FindList(eventId);
+    if (index == _listenerLists.size())
+    {
+        _listenerLists.push_back({ eventId, std::vector<Listener>(), 0, 0 });
+    }
 
-    for (IEventCallback * callback : listIt->second)
+    EventListenerID id;
+    if (_freeSlots.empty())
     {
-        delete callback;
+        id.slot = (unsigned int)_slots.size();
+        _slots.push_back({ 0, 0, 0 });
     }
-    listIt->second.clear();
-    if (_deadEventListeners.find(eventId) != _deadEventListeners.end())
+    else
     {
-        _deadEventListeners[eventId].clear();
+        id.slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+
+    ListenerList& list = _listenerLists[index];
+
+    Slot& slot = _slots[id.slot];
+    slot.list = (unsigned int)index;
+    slot.index = (unsigned int)list.listeners.size();
+    id.generation = slot.generation;
+
+    list.listeners.push_back({ delegate, id.slot, false });
+    ++list.liveCount;
+
+    return id;
+}
+
+void IEventDispatcher::KillListener(ListenerList& list, Listener& listener)
+{
+    if (listener.dead)
+    {
+        return;
+    }
+
+    listener.dead = true;
+    --list.liveCount;
+    ++list.deadCount;
+
+    // Old ids for this slot stop matching as soon as the listener is gone
+    ++_slots[listener.slot].generation;
+    _freeSlots.push_back(listener.slot);
+}
+
+void IEventDispatcher::Compact(bool force)
+{
+    if (_dispatchDepth > 0)
+    {
+        return;
+    }
+
+    for (ListenerList& list : _listenerLists)
+    {
+        if (0 == list.deadCount || (!force && list.deadCount < list.liveCount))
+        {
+            continue;
+        }
+
+        // Keep the survivors in the order they were added
+        size_t alive = 0;
+        for (size_t i = 0; i < list.listeners.size(); ++i)
+        {
+            Listener& listener = list.listeners[i];
+            if (listener.dead)
+            {
+                delete listener.delegate.GetCallback();
+                continue;
+            }
+
+            _slots[listener.slot].index = (unsigned int)alive;
+            list.listeners[alive++] = listener;
+        }
+
+        list.listeners.resize(alive);
+        list.deadCount = 0;
     }
 }
 
 void IEventDispatcher::InitScripting()
 {
-    ScriptHost::AddFunction("dusk_IEventDispatcher_AddEventListener",
-                            &IEventDispatcher::Script_AddEventListener);
-    ScriptHost::AddFunction("dusk_IEventDispatcher_RemoveEventListener",
-                            &IEventDispatcher::Script_RemoveEventListener);
+    ScriptHost::AddBinding(&IEventDispatcher::BindScripting);
+}
+
+void IEventDispatcher::BindScripting(lua_State * L)
+{
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    // Raw functions, listeners need the Lua stack to take their references
+    dusk.new_usertype<IEventDispatcher>("IEventDispatcher",
+        "new", sol::no_constructor,
+        "AddEventListener", &IEventDispatcher::Script_AddEventListener,
+        "RemoveEventListener", &IEventDispatcher::Script_RemoveEventListener,
+        "PostEvent", &IEventDispatcher::Script_PostEvent);
 }
 
 int IEventDispatcher::Script_AddEventListener(lua_State * L)
 {
-    IEventDispatcher * disp = (IEventDispatcher *)lua_tointeger(L, 1);
+    ScriptCommandBuffer::CheckMainThread(L, "IEventDispatcher:AddEventListener");
+
+    IEventDispatcher * disp = sol::stack::get<IEventDispatcher *>(L, 1);
 
-    std::string funcName = lua_tostring(L, 3);
-    disp->AddEventListener((EventID)lua_tointeger(L, 2),
-                           new LuaEventCallback(L, funcName));
+    disp->AddEventListener((EventID)luaL_checkinteger(L, 2),
+                           new LuaEventCallback(L, 3, ScriptHost::GetCurrentEnv()));
 
     return 0;
 }
 
 int IEventDispatcher::Script_RemoveEventListener(lua_State * L)
 {
-    IEventDispatcher * disp = (IEventDispatcher *)lua_tointeger(L, 1);
+    ScriptCommandBuffer::CheckMainThread(L, "IEventDispatcher:RemoveEventListener");
+
+    IEventDispatcher * disp = sol::stack::get<IEventDispatcher *>(L, 1);
 
     DuskLogWarn("Removing Lua Event Listener");
 
-    std::string funcName = lua_tostring(L, 3);
-    LuaEventCallback tmp(L, funcName);
-    disp->RemoveEventListener((EventID)lua_tointeger(L, 2), &tmp);
+    LuaEventCallback tmp(L, 3, ScriptHost::GetCurrentEnv());
+    disp->RemoveEventListener((EventID)luaL_checkinteger(L, 2), &tmp);
+
+    return 0;
+}
+
+int IEventDispatcher::Script_PostEvent(lua_State * L)
+{
+    ScriptCommandBuffer::CheckMainThread(L, "IEventDispatcher:PostEvent");
+
+    IEventDispatcher * disp = sol::stack::get<IEventDispatcher *>(L, 1);
+
+    disp->PostEvent((EventID)luaL_checkinteger(L, 2), (bool)lua_toboolean(L, 3));
 
     return 0;
 }
@@ -0,0 +1,149 @@
+#include "dusk/EventQueue.hpp"
+
+#include <dusk/EventDispatcher.hpp>
+#include <algorithm>
+
+namespace dusk {
+
+EventQueue * EventQueue::_Inst = nullptr;
+
+EventQueue::EventQueue()
+    : _pending(0)
+    , _dispatching(false)
+{
+    _Inst = this;
+}
+
+EventQueue::~EventQueue()
+{
+    if (this == _Inst)
+    {
+        _Inst = nullptr;
+    }
+}
+
+void EventQueue::Cancel(IEventDispatcher * target)
+{
+    for (Frame& frame : _frames)
+    {
+        for (QueuedEvent& queued : frame.events)
+        {
+            if (queued.target == target)
+            {
+                queued.target = nullptr;
+            }
+        }
+    }
+
+    target->_queuedEvents = 0;
+}
+
+void EventQueue::Dispatch()
+{
+    // A listener draining the queue again would deliver out of order
+    if (_dispatching)
+    {
+        return;
+    }
+
+    _dispatching = true;
+
+    Frame& frame = _frames[_pending];
+    _pending ^= 1;
+
+    // Listeners may post or cancel while we deliver, so index every time
+    for (size_t i = 0; i < frame.events.size(); ++i)
+    {
+        QueuedEvent queued = frame.events[i];
+        if (!queued.target)
+        {
+            continue;
+        }
+
+        --queued.target->_queuedEvents;
+        queued.target->DispatchEvent(Event(queued.eventId, *queued.data));
+    }
+
+    frame.events.clear();
+
+    if (frame.coalesceCount > 0)
+    {
+        std::fill(frame.coalesce.begin(), frame.coalesce.end(), CoalesceSlot{ nullptr, 0, 0 });
+        frame.coalesceCount = 0;
+    }
+
+    frame.arena.Reset();
+
+    _dispatching = false;
+}
+
+void EventQueue::Push(IEventDispatcher * target, const EventID& eventId, const EventData * data, bool coalesce)
+{
+    Frame& frame = _frames[_pending];
+
+    if (coalesce)
+    {
+        if ((frame.coalesceCount + 1) * 2 > frame.coalesce.size())
+        {
+            GrowCoalesceTable(frame);
+        }
+
+        CoalesceSlot * slot = FindCoalesceSlot(frame, target, eventId);
+        if (slot->target)
+        {
+            QueuedEvent& queued = frame.events[slot->index];
+
+            // The slot may point at an event cancelled for an old dispatcher
+            // that lived at the same address
+            if (queued.target == target)
+            {
+                queued.data = data;
+                return;
+            }
+        }
+        else
+        {
+            slot->target = target;
+            slot->eventId = eventId;
+            ++frame.coalesceCount;
+        }
+
+        slot->index = frame.events.size();
+    }
+
+    frame.events.push_back({ target, eventId, data, coalesce });
+    ++target->_queuedEvents;
+}
+
+EventQueue::CoalesceSlot * EventQueue::FindCoalesceSlot(Frame& frame, IEventDispatcher * target, const EventID& eventId)
+{
+    size_t mask = frame.coalesce.size() - 1;
+    size_t hash = (((size_t)target >> 4) * 31u + eventId) * 2654435761u;
+
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        CoalesceSlot& slot = frame.coalesce[i];
+        if (!slot.target || (slot.target == target && slot.eventId == eventId))
+        {
+            return &slot;
+        }
+    }
+}
+
+void EventQueue::GrowCoalesceTable(Frame& frame)
+{
+    std::vector<CoalesceSlot> old;
+    old.swap(frame.coalesce);
+
+    frame.coalesce.assign(std::max<size_t>(16, old.size() * 2), CoalesceSlot{ nullptr, 0, 0 });
+
+    for (const CoalesceSlot& slot : old)
+    {
+        if (slot.target)
+        {
+            *FindCoalesceSlot(frame, slot.target, slot.eventId) = slot;
+        }
+    }
+}
+
+} // namespace dusk
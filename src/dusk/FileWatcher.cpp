@@ -0,0 +1,278 @@
+#include "dusk/FileWatcher.hpp"
+
+#include <dusk/Log.hpp>
+#include <dusk/Util.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+
+#if defined(DUSK_OS_LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace dusk {
+
+const FileWatcher::WatchID FileWatcher::INVALID_WATCH;
+const double FileWatcher::POLL_INTERVAL = 0.5;
+
+FileWatcher::FileWatcher()
+    : _enabled(false)
+    , _nextId(INVALID_WATCH + 1)
+#if defined(DUSK_OS_LINUX)
+    , _inotify(-1)
+#endif
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    SetEnabled(false);
+}
+
+void FileWatcher::SetEnabled(bool enabled)
+{
+    if (enabled == _enabled)
+    {
+        return;
+    }
+
+#if defined(DUSK_OS_LINUX)
+
+    if (enabled)
+    {
+        _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotify < 0)
+        {
+            DuskLogError("Failed to start inotify, %s", strerror(errno));
+            return;
+        }
+
+        _enabled = true;
+
+        for (const Watcher& watcher : _watchers)
+        {
+            AddDirectory(watcher.filename);
+        }
+    }
+    else
+    {
+        close(_inotify);
+        _inotify = -1;
+
+        _directories.clear();
+    }
+
+#else
+
+    if (enabled)
+    {
+        // Only changes made from now on count
+        for (Watcher& watcher : _watchers)
+        {
+            watcher.mtime = GetModifiedTime(watcher.filename);
+        }
+
+        _lastPoll = std::chrono::steady_clock::now();
+    }
+
+#endif
+
+    _enabled = enabled;
+
+    DuskLogInfo("Hot reload %s", (_enabled ? "enabled" : "disabled"));
+}
+
+FileWatcher::WatchID FileWatcher::Watch(const std::string& filename, Callback callback)
+{
+    std::string path = filename;
+    CleanSlashes(path);
+
+    WatchID id = _nextId++;
+    _watchers.push_back({ id, path, callback, GetModifiedTime(path) });
+
+#if defined(DUSK_OS_LINUX)
+    if (_enabled)
+    {
+        AddDirectory(path);
+    }
+#endif
+
+    return id;
+}
+
+void FileWatcher::Unwatch(WatchID id)
+{
+    auto it = std::find_if(_watchers.begin(), _watchers.end(), [id](const Watcher& watcher) {
+        return watcher.id == id;
+    });
+
+    if (it != _watchers.end())
+    {
+        _watchers.erase(it);
+    }
+}
+
+void FileWatcher::Poll()
+{
+    if (!_enabled)
+    {
+        return;
+    }
+
+    CollectChanges();
+
+    for (const std::string& filename : _changed)
+    {
+        _pending.clear();
+        for (const Watcher& watcher : _watchers)
+        {
+            if (watcher.filename == filename)
+            {
+                _pending.push_back(watcher.id);
+            }
+        }
+
+        if (_pending.empty())
+        {
+            continue;
+        }
+
+        DuskLogInfo("File '%s' changed", filename.c_str());
+
+        for (WatchID id : _pending)
+        {
+            auto it = std::find_if(_watchers.begin(), _watchers.end(), [id](const Watcher& watcher) {
+                return watcher.id == id;
+            });
+
+            // Removed by an earlier callback
+            if (it == _watchers.end())
+            {
+                continue;
+            }
+
+            // Callbacks can add watches, which may move the watcher
+            Callback callback = it->callback;
+            callback(filename);
+        }
+    }
+}
+
+time_t FileWatcher::GetModifiedTime(const std::string& filename)
+{
+    struct stat info;
+    if (0 != stat(filename.c_str(), &info))
+    {
+        return 0;
+    }
+
+    return info.st_mtime;
+}
+
+#if defined(DUSK_OS_LINUX)
+
+void FileWatcher::AddDirectory(const std::string& filename)
+{
+    size_t pivot = filename.find_last_of('/');
+    std::string dirname = (pivot == std::string::npos ? "." : filename.substr(0, pivot));
+
+    // Watching the directory again returns the same descriptor
+    int wd = inotify_add_watch(_inotify, dirname.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0)
+    {
+        DuskLogWarn("Failed to watch directory '%s', %s", dirname.c_str(), strerror(errno));
+        return;
+    }
+
+    _directories[wd] = dirname;
+}
+
+void FileWatcher::CollectChanges()
+{
+    alignas(struct inotify_event) char buffer[4096];
+
+    _changed.clear();
+
+    while (true)
+    {
+        ssize_t length = read(_inotify, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            // EAGAIN once the queue is drained
+            break;
+        }
+
+        for (char * ptr = buffer; ptr < buffer + length; )
+        {
+            const struct inotify_event * event = (const struct inotify_event *)ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            // Events were lost, so assume everything changed
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                DuskLogWarn("Too many file changes at once, reloading everything");
+
+                _changed.clear();
+                for (const Watcher& watcher : _watchers)
+                {
+                    if (std::find(_changed.begin(), _changed.end(), watcher.filename) == _changed.end())
+                    {
+                        _changed.push_back(watcher.filename);
+                    }
+                }
+                continue;
+            }
+
+            auto it = _directories.find(event->wd);
+            if (0 == event->len || it == _directories.end())
+            {
+                continue;
+            }
+
+            std::string path = (it->second == "." ? std::string(event->name) : it->second + "/" + event->name);
+            if (std::find(_changed.begin(), _changed.end(), path) == _changed.end())
+            {
+                _changed.push_back(path);
+            }
+        }
+    }
+}
+
+#else
+
+void FileWatcher::CollectChanges()
+{
+    _changed.clear();
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - _lastPoll;
+    if (elapsed.count() < POLL_INTERVAL)
+    {
+        return;
+    }
+
+    _lastPoll = now;
+
+    for (Watcher& watcher : _watchers)
+    {
+        time_t mtime = GetModifiedTime(watcher.filename);
+        if (mtime == watcher.mtime)
+        {
+            continue;
+        }
+
+        watcher.mtime = mtime;
+
+        if (std::find(_changed.begin(), _changed.end(), watcher.filename) == _changed.end())
+        {
+            _changed.push_back(watcher.filename);
+        }
+    }
+}
+
+#endif
+
+} // namespace dusk
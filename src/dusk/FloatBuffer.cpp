@@ -0,0 +1,84 @@
+#include "dusk/FloatBuffer.hpp"
+
+#include <dusk/ScriptHost.hpp>
+
+namespace dusk {
+
+void FloatBuffer::InitScripting()
+{
+    ScriptHost::AddBinding(&FloatBuffer::BindScripting);
+}
+
+void FloatBuffer::BindScripting(lua_State * L)
+{
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    // Element access is bound raw, it's called in the tightest script loops
+    dusk.new_usertype<FloatBuffer>("FloatBuffer",
+        sol::constructors<FloatBuffer(), FloatBuffer(size_t)>(),
+        "Get", &FloatBuffer::Script_Get,
+        "Set", &FloatBuffer::Script_Set,
+        "GetVec3", &FloatBuffer::Script_GetVec3,
+        "SetVec3", &FloatBuffer::Script_SetVec3,
+        "Resize", &FloatBuffer::Resize,
+        "GetSize", &FloatBuffer::GetSize,
+        sol::meta_function::length, &FloatBuffer::GetSize);
+}
+
+static FloatBuffer * CheckBuffer(lua_State * L, size_t& index, size_t width)
+{
+    FloatBuffer * buffer = sol::stack::get<FloatBuffer *>(L, 1);
+    lua_Integer pos = luaL_checkinteger(L, 2);
+
+    luaL_argcheck(L, pos >= 1 && (size_t)(pos - 1) * width + width <= buffer->GetSize(), 2, "index out of range");
+
+    index = (size_t)(pos - 1) * width;
+    return buffer;
+}
+
+int FloatBuffer::Script_Get(lua_State * L)
+{
+    size_t index;
+    FloatBuffer * buffer = CheckBuffer(L, index, 1);
+
+    lua_pushnumber(L, buffer->Get(index));
+
+    return 1;
+}
+
+int FloatBuffer::Script_Set(lua_State * L)
+{
+    size_t index;
+    FloatBuffer * buffer = CheckBuffer(L, index, 1);
+
+    buffer->Set(index, (float)luaL_checknumber(L, 3));
+
+    return 0;
+}
+
+int FloatBuffer::Script_GetVec3(lua_State * L)
+{
+    size_t index;
+    FloatBuffer * buffer = CheckBuffer(L, index, 3);
+
+    lua_pushnumber(L, buffer->Get(index));
+    lua_pushnumber(L, buffer->Get(index + 1));
+    lua_pushnumber(L, buffer->Get(index + 2));
+
+    return 3;
+}
+
+int FloatBuffer::Script_SetVec3(lua_State * L)
+{
+    size_t index;
+    FloatBuffer * buffer = CheckBuffer(L, index, 3);
+
+    buffer->Set(index, (float)luaL_checknumber(L, 3));
+    buffer->Set(index + 1, (float)luaL_checknumber(L, 4));
+    buffer->Set(index + 2, (float)luaL_checknumber(L, 5));
+
+    return 0;
+}
+
+} // namespace dusk
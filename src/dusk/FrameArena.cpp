@@ -0,0 +1,81 @@
+#include "dusk/FrameArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace dusk {
+
+FrameArena::FrameArena(size_t blockSize /*= 64 * 1024*/)
+    : _blockSize(blockSize)
+    , _blocks()
+    , _offset(0)
+    , _used(0)
+    , _capacity(0)
+    , _destructors(nullptr)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    Reset();
+}
+
+void * FrameArena::Allocate(size_t size, size_t align /*= alignof(std::max_align_t)*/)
+{
+    if (_blocks.empty())
+    {
+        AddBlock(size + align);
+    }
+
+    Block * block = &_blocks.back();
+    uintptr_t base = (uintptr_t)block->data.get();
+    size_t start = ((base + _offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+
+    if (start + size > block->size)
+    {
+        AddBlock(size + align);
+
+        block = &_blocks.back();
+        base = (uintptr_t)block->data.get();
+        start = ((base + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    }
+
+    _used += (start + size) - _offset;
+    _offset = start + size;
+
+    return block->data.get() + start;
+}
+
+void FrameArena::Reset()
+{
+    for (Destructor * dtor = _destructors; dtor; dtor = dtor->next)
+    {
+        dtor->destroy(dtor->object);
+    }
+    _destructors = nullptr;
+
+    // Fold overflow blocks into one that fits the whole frame next time
+    if (_blocks.size() > 1)
+    {
+        _blockSize = std::max(_blockSize, _capacity);
+        _blocks.clear();
+        _capacity = 0;
+        AddBlock(_blockSize);
+    }
+
+    _offset = 0;
+    _used = 0;
+}
+
+void FrameArena::AddBlock(size_t minSize)
+{
+    Block block;
+    block.size = std::max(_blockSize, minSize);
+    block.data.reset(new unsigned char[block.size]);
+
+    _capacity += block.size;
+    _blocks.push_back(std::move(block));
+    _offset = 0;
+}
+
+} // namespace dusk
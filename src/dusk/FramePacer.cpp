@@ -0,0 +1,176 @@
+#include "dusk/FramePacer.hpp"
+
+#include <dusk/Log.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace dusk {
+
+const double FramePacer::IDLE_FPS = 10.0;
+const double FramePacer::FPS_INTERVAL = 0.25;
+
+// Milliseconds, sleeps are never trusted to wake any closer than this
+static const double MIN_SLEEP_SLACK = 0.25;
+
+// Milliseconds, wakeups later than this are a stall rather than the timer
+static const double MAX_SLEEP_SLACK = 2.0;
+
+FramePacer::FramePacer()
+    : _mode(Mode::LIMITED)
+    , _targetFPS(60.0)
+    , _idle(false)
+    , _frameTime(0.0)
+    , _waitTime(0.0)
+    , _sleepSlack(1.0)
+    , _fpsFrames(0)
+    , _currentFPS(0.0)
+{
+    Reset();
+}
+
+bool FramePacer::ParseMode(const std::string& name, Mode& mode)
+{
+    if ("VSync" == name)
+    {
+        mode = Mode::VSYNC;
+    }
+    else if ("Limited" == name)
+    {
+        mode = Mode::LIMITED;
+    }
+    else if ("Uncapped" == name)
+    {
+        mode = Mode::UNCAPPED;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void FramePacer::SetMode(Mode mode)
+{
+    _mode = mode;
+
+    if (glfwGetCurrentContext())
+    {
+        glfwSwapInterval(Mode::VSYNC == _mode ? 1 : 0);
+    }
+}
+
+void FramePacer::SetTargetFPS(double fps)
+{
+    if (fps <= 0.0)
+    {
+        DuskLogWarn("Ignoring invalid target FPS %f", fps);
+        return;
+    }
+
+    _targetFPS = fps;
+}
+
+void FramePacer::Reset()
+{
+    Clock::time_point now = Clock::now();
+
+    _frameStart = now;
+    _nextFrame = now;
+
+    _fpsStart = now;
+    _fpsFrames = 0;
+}
+
+double FramePacer::BeginFrame()
+{
+    Clock::time_point now = Clock::now();
+
+    std::chrono::duration<double> elapsed = now - _frameStart;
+    _frameStart = now;
+    _frameTime = elapsed.count() * 1000.0;
+
+    ++_fpsFrames;
+
+    std::chrono::duration<double> fpsElapsed = now - _fpsStart;
+    if (fpsElapsed.count() >= FPS_INTERVAL)
+    {
+        _currentFPS = _fpsFrames / fpsElapsed.count();
+
+        _fpsStart = now;
+        _fpsFrames = 0;
+    }
+
+    return elapsed.count();
+}
+
+void FramePacer::EndFrame()
+{
+    Clock::time_point now = Clock::now();
+
+    double fps = (_idle ? IDLE_FPS : _targetFPS);
+    if (!_idle && Mode::LIMITED != _mode)
+    {
+        // The swap already waited, if it was going to
+        _nextFrame = now;
+        _waitTime = 0.0;
+        return;
+    }
+
+    Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+
+    // Deadlines follow on from each other so the average rate is exact, but
+    // after a long stall we start over rather than rush to catch up
+    _nextFrame += period;
+    if (_nextFrame + period < now)
+    {
+        _nextFrame = now;
+    }
+
+    WaitUntil(_nextFrame, period);
+
+    std::chrono::duration<double, std::milli> waited = Clock::now() - now;
+    _waitTime = waited.count();
+}
+
+void FramePacer::WaitUntil(Clock::time_point deadline, Clock::duration period)
+{
+    Clock::time_point now = Clock::now();
+
+    std::chrono::duration<double, std::milli> periodMs = period;
+    double maxSlack = std::max(MIN_SLEEP_SLACK, std::min(periodMs.count() * 0.25, MAX_SLEEP_SLACK));
+
+    std::chrono::duration<double, std::milli> remaining = deadline - now;
+    if (remaining.count() > _sleepSlack)
+    {
+        std::chrono::duration<double, std::milli> request(remaining.count() - _sleepSlack);
+        SleepFor(request);
+
+        std::chrono::duration<double, std::milli> slept = Clock::now() - now;
+        double overshoot = std::min(slept.count() - request.count(), maxSlack);
+
+        // Late wakeups are accounted for at once, and forgotten slowly
+        _sleepSlack = std::max(overshoot, _sleepSlack * 0.95 + overshoot * 0.05);
+    }
+    else
+    {
+        // Keep forgetting, or a frame that's always short never sleeps again
+        _sleepSlack *= 0.95;
+    }
+
+    _sleepSlack = std::max(MIN_SLEEP_SLACK, std::min(_sleepSlack, maxSlack));
+
+    // The last stretch is too short to trust to the scheduler
+    while (Clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::SleepFor(std::chrono::duration<double, std::milli> duration)
+{
+    std::this_thread::sleep_for(duration);
+}
+
+} // namespace dusk
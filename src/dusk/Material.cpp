@@ -7,6 +7,8 @@
 
 namespace dusk {
 
+unsigned int Material::_NextSortId = 1;
+
 std::shared_ptr<Material>
 Material::Parse(nlohmann::json & data)
 {
@@ -121,7 +123,8 @@ Material::Material(glm::vec4 ambient,
                    const std::string& diffuseMap,
                    const std::string& specularMap,
                    const std::string& bumpMap)
-    : _ambient(ambient)
+    : _sortId(_NextSortId++)
+    , _ambient(ambient)
     , _diffuse(diffuse)
     , _specular(specular)
     , _shininess(shininess)
@@ -198,7 +201,31 @@ void Material::Bind(Shader * shader)
         _bumpMap->Bind();
     }
 
-    glActiveTexture(0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Material::BindSamplers(Shader * shader)
+{
+    glUniform1i(shader->GetUniformLocation("_AmbientMap"), Material::TextureID::AMBIENT);
+    glUniform1i(shader->GetUniformLocation("_DiffuseMap"), Material::TextureID::DIFFUSE);
+    glUniform1i(shader->GetUniformLocation("_SpecularMap"), Material::TextureID::SPECULAR);
+    glUniform1i(shader->GetUniformLocation("_BumpMap"), Material::TextureID::BUMP);
+}
+
+Texture * Material::GetMap(TextureID id) const
+{
+    switch (id)
+    {
+    case TextureID::AMBIENT:
+        return _ambientMap.get();
+    case TextureID::DIFFUSE:
+        return _diffuseMap.get();
+    case TextureID::SPECULAR:
+        return _specularMap.get();
+    case TextureID::BUMP:
+        return _bumpMap.get();
+    }
+    return nullptr;
 }
 
 std::string Material::GetId()
@@ -4,16 +4,64 @@
 #include <dusk/Benchmark.hpp>
 #include <dusk/App.hpp>
 #include <dusk/Asset.hpp>
+#include <unordered_map>
+#include <cstddef>
 
 namespace dusk {
 
+struct VertexHash
+{
+    size_t operator()(const Vertex& vert) const
+    {
+        // FNV-1a over the raw vertex bytes
+        const unsigned char * bytes = (const unsigned char *)&vert;
+        size_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(Vertex); ++i)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+struct ObjIndexKey
+{
+    int vertex;
+    int normal;
+    int texcoord;
+
+    inline bool operator==(const ObjIndexKey& rhs) const
+    {
+        return vertex == rhs.vertex && normal == rhs.normal && texcoord == rhs.texcoord;
+    }
+};
+
+struct ObjIndexHash
+{
+    size_t operator()(const ObjIndexKey& key) const
+    {
+        size_t hash = std::hash<int>()(key.vertex);
+        hash = hash * 31 + std::hash<int>()(key.normal);
+        hash = hash * 31 + std::hash<int>()(key.texcoord);
+        return hash;
+    }
+};
+
 Mesh::Mesh()
     : _renderGroups()
+    , _bounds()
+    , _boundingSphere()
 {
 }
 
 Mesh::~Mesh()
 {
+    for (RenderGroup& group : _renderGroups)
+    {
+        glDeleteBuffers(1, &group.glVBO);
+        glDeleteBuffers(1, &group.glIBO);
+        glDeleteVertexArrays(1, &group.glVAO);
+    }
 }
 
 std::shared_ptr<Mesh> Mesh::Parse(nlohmann::json & data)
@@ -71,19 +119,21 @@ void Mesh::Update()
 {
 }
 
-void Mesh::Render(Shader * shader)
+void Mesh::Render(RenderQueue * queue, Shader * shader, TransformData * transform)
 {
     for (RenderGroup& group : _renderGroups)
     {
-        if (group.material)
-        {
-            group.material->Bind(shader);
-        }
+        DrawItem item;
+        item.shader = shader;
+        item.material = group.material.get();
+        item.glVAO = group.glVAO;
+        item.drawMode = group.drawMode;
+        item.indexCount = group.indexCount;
+        item.indexType = group.indexType;
+        item.transform = transform;
 
-        glBindVertexArray(group.glVAO);
-        glDrawArrays(group.drawMode, 0, group.vertCount);
+        queue->Add(item);
     }
-    glBindVertexArray(0);
 }
 
 bool Mesh::AddRenderGroup(std::shared_ptr<Material> material,
@@ -116,40 +166,113 @@ bool Mesh::AddRenderGroup(std::shared_ptr<Material> material,
                           const float * verts,
                           const float * norms,
                           const float * txcds)
+{
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    std::unordered_map<Vertex, GLuint, VertexHash> unique;
+
+    vertices.reserve(vertCount);
+    indices.reserve(vertCount);
+
+    for (unsigned int i = 0; i < vertCount; ++i)
+    {
+        Vertex vert;
+        vert.position = glm::vec3(verts[i * 3 + 0], verts[i * 3 + 1], verts[i * 3 + 2]);
+
+        if (norms)
+        {
+            vert.normal = glm::vec3(norms[i * 3 + 0], norms[i * 3 + 1], norms[i * 3 + 2]);
+        }
+
+        if (txcds)
+        {
+            vert.texcoord = glm::vec2(txcds[i * 2 + 0], txcds[i * 2 + 1]);
+        }
+
+        auto it = unique.find(vert);
+        if (it == unique.end())
+        {
+            it = unique.emplace(vert, (GLuint)vertices.size()).first;
+            vertices.push_back(vert);
+        }
+        indices.push_back(it->second);
+    }
+
+    return AddRenderGroup(material, drawMode, vertices, indices);
+}
+
+bool Mesh::AddRenderGroup(std::shared_ptr<Material> material,
+                          GLenum drawMode,
+                          const std::vector<Vertex>& vertices,
+                          const std::vector<GLuint>& indices)
 {
     RenderGroup group;
-    group.vertCount = (GLsizei)vertCount;
+    group.vertCount = (GLsizei)vertices.size();
+    group.indexCount = (GLsizei)indices.size();
     group.material = material;
     group.drawMode = drawMode;
 
+    AABB groupBounds;
+    for (const Vertex& vert : vertices)
+    {
+        groupBounds.Expand(vert.position);
+    }
+
+    BoundingSphere groupSphere;
+    groupSphere.center = groupBounds.GetCenter();
+    groupSphere.radius = 0.0f;
+    for (const Vertex& vert : vertices)
+    {
+        groupSphere.radius = std::fmax(groupSphere.radius, glm::length(vert.position - groupSphere.center));
+    }
+
+    _bounds.Expand(groupBounds);
+    _boundingSphere.Expand(groupSphere);
+
     glGenVertexArrays(1, &group.glVAO);
     glBindVertexArray(group.glVAO);
 
-    glGenBuffers(3, group.glVBOs);
+    glGenBuffers(1, &group.glVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, group.glVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, group.glVBOs[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * vertCount, verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(Mesh::AttrID::VERTS, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glVertexAttribPointer(Mesh::AttrID::VERTS, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (GLvoid *)offsetof(Vertex, position));
     glEnableVertexAttribArray(Mesh::AttrID::VERTS);
 
-    if (norms)
+    glVertexAttribPointer(Mesh::AttrID::NORMS, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (GLvoid *)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(Mesh::AttrID::NORMS);
+
+    glVertexAttribPointer(Mesh::AttrID::TXCDS, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (GLvoid *)offsetof(Vertex, texcoord));
+    glEnableVertexAttribArray(Mesh::AttrID::TXCDS);
+
+    glGenBuffers(1, &group.glIBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, group.glIBO);
+
+    // Use 16-bit indices whenever the group is small enough
+    if (vertices.size() <= 0xFFFF)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, group.glVBOs[1]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * vertCount, norms, GL_STATIC_DRAW);
-        glVertexAttribPointer(Mesh::AttrID::NORMS, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(Mesh::AttrID::NORMS);
-    }
+        std::vector<GLushort> shortIndices(indices.begin(), indices.end());
 
-    if (txcds)
+        group.indexType = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * shortIndices.size(),
+                     shortIndices.data(), GL_STATIC_DRAW);
+    }
+    else
     {
-        glBindBuffer(GL_ARRAY_BUFFER, group.glVBOs[2]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * vertCount, txcds, GL_STATIC_DRAW);
-        glVertexAttribPointer(Mesh::AttrID::TXCDS, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-        glEnableVertexAttribArray(Mesh::AttrID::TXCDS);
+        group.indexType = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(),
+                     indices.data(), GL_STATIC_DRAW);
     }
 
+    // The element buffer binding is part of the VAO state, so unbind it last
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    DuskLogVerbose("Added render group with %d vertices, %d indices", group.vertCount, group.indexCount);
 
     _renderGroups.push_back(group);
     return true;
@@ -162,8 +285,10 @@ std::shared_ptr<FileMesh> FileMesh::Create(const std::string& filename)
     std::shared_ptr<Mesh> ptr = app->GetMeshCache()->Get(id);
     if (!ptr)
     {
-        ptr.reset(new FileMesh(filename));
-        app->GetMeshCache()->Add(id, ptr);
+        std::shared_ptr<FileMesh> fileMesh(new FileMesh(filename));
+        app->GetMeshCache()->Add(id, fileMesh);
+        app->GetAssetLoader()->Queue(fileMesh);
+        return fileMesh;
     }
     return std::dynamic_pointer_cast<FileMesh>(ptr);
 }
@@ -172,17 +297,73 @@ FileMesh::FileMesh(const std::string& filename)
     : Mesh()
     , _filename(filename)
 {
+}
+
+bool FileMesh::Load()
+{
+    DuskBenchStart();
+
     DuskLogInfo("Loading model from '%s'", _filename.c_str());
 
+    bool ret = false;
+
     std::string ext = GetExtension(_filename);
     if (ext == "obj")
     {
-        LoadOBJ(_filename);
+        ret = LoadOBJ(_filename);
     }
     else if (ext == "dmf" || ext == "dmfz")
     {
-        //LoadDMF(_filename);
+        //ret = LoadDMF(_filename);
     }
+
+    DuskBenchEnd("FileMesh::Load()");
+    return ret;
+}
+
+bool FileMesh::Upload()
+{
+    std::string dirname = GetDirname(_filename) + "/";
+
+    for (PendingGroup& group : _pendingGroups)
+    {
+        std::shared_ptr<Material> material;
+        if (group.hasMaterial)
+        {
+            tinyobj::material_t * mat = &group.material;
+
+            std::string ambient_texname = (mat->ambient_texname.empty()
+                ? std::string()
+                : dirname + mat->ambient_texname);
+            std::string diffuse_texname = (mat->diffuse_texname.empty()
+                ? std::string()
+                : dirname + mat->diffuse_texname);
+            std::string specular_texname = (mat->specular_texname.empty()
+                ? std::string()
+                : dirname + mat->specular_texname);
+            std::string bump_texname = (mat->bump_texname.empty()
+                ? std::string()
+                : dirname + mat->bump_texname);
+
+            material = Material::Create(
+                glm::vec4(mat->ambient[0], mat->ambient[1], mat->ambient[2], 1.0f),
+                glm::vec4(mat->diffuse[0], mat->diffuse[1], mat->diffuse[2], 1.0f),
+                glm::vec4(mat->specular[0], mat->specular[1], mat->specular[2], 1.0f),
+                mat->shininess, mat->dissolve,
+                ambient_texname,
+                diffuse_texname,
+                specular_texname,
+                bump_texname
+            );
+        }
+        AddRenderGroup(material, GL_TRIANGLES, group.vertices, group.indices);
+    }
+
+    _pendingGroups.clear();
+    _pendingGroups.shrink_to_fit();
+
+    SetLoaded(true);
+    return true;
 }
 
 bool FileMesh::LoadOBJ(const std::string& filename)
@@ -208,87 +389,66 @@ bool FileMesh::LoadOBJ(const std::string& filename)
 
     for (tinyobj::shape_t & shape : shapes)
     {
-        tinyobj::mesh_t &     mesh = shape.mesh;
-        tinyobj::material_t * mat  = nullptr;
+        tinyobj::mesh_t & mesh = shape.mesh;
 
-        if (!mesh.material_ids.empty() && mesh.material_ids[0] >= 0)
+        _pendingGroups.emplace_back();
+        PendingGroup& group = _pendingGroups.back();
+
+        group.hasMaterial = (!mesh.material_ids.empty() && mesh.material_ids[0] >= 0);
+        if (group.hasMaterial)
         {
-            mat = &materials[mesh.material_ids[0]];
+            group.material = materials[mesh.material_ids[0]];
         }
 
-        std::vector<float> verts;
-        std::vector<float> norms;
-        std::vector<float> txcds;
+        // Each unique vertex/normal/texcoord triple becomes one vertex
+        std::unordered_map<ObjIndexKey, GLuint, ObjIndexHash> unique;
 
-        verts.resize(mesh.indices.size() * 3);
+        group.vertices.reserve(mesh.indices.size());
+        group.indices.reserve(mesh.indices.size());
 
-        if (has_norms)
+        for (const tinyobj::index_t& idx : mesh.indices)
         {
-            norms.resize(mesh.indices.size() * 3);
-        }
+            ObjIndexKey key = { idx.vertex_index, idx.normal_index, idx.texcoord_index };
 
-        if (has_txcds)
-        {
-            txcds.resize(mesh.indices.size() * 2);
-        }
+            auto it = unique.find(key);
+            if (it != unique.end())
+            {
+                group.indices.push_back(it->second);
+                continue;
+            }
 
-        size_t index = 0;
-        for (size_t f = 0; f < mesh.num_face_vertices.size(); ++f)
-        {
-            size_t fv = mesh.num_face_vertices[f];
+            Vertex vert;
 
-            for (size_t v = 0; v < fv; ++v)
+            vert.position = glm::vec3(
+                attrib.vertices[3 * idx.vertex_index + 0],
+                attrib.vertices[3 * idx.vertex_index + 1],
+                attrib.vertices[3 * idx.vertex_index + 2]);
+
+            if (has_norms && idx.normal_index >= 0)
             {
-                tinyobj::index_t idx = mesh.indices[index + v];
-
-                verts[(index + v) * 3 + 0] = attrib.vertices[3 * idx.vertex_index + 0];
-                verts[(index + v) * 3 + 1] = attrib.vertices[3 * idx.vertex_index + 1];
-                verts[(index + v) * 3 + 2] = attrib.vertices[3 * idx.vertex_index + 2];
-
-                if (has_norms)
-                {
-                    norms[(index + v) * 3 + 0] = attrib.normals[3 * idx.normal_index + 0];
-                    norms[(index + v) * 3 + 1] = attrib.normals[3 * idx.normal_index + 1];
-                    norms[(index + v) * 3 + 2] = attrib.normals[3 * idx.normal_index + 2];
-                }
-
-                if (has_txcds)
-                {
-                    txcds[(index + v) * 2 + 0] = attrib.texcoords[2 * idx.texcoord_index + 0];
-                    txcds[(index + v) * 2 + 1] = attrib.texcoords[2 * idx.texcoord_index + 1];
-                }
+                vert.normal = glm::vec3(
+                    attrib.normals[3 * idx.normal_index + 0],
+                    attrib.normals[3 * idx.normal_index + 1],
+                    attrib.normals[3 * idx.normal_index + 2]);
             }
-            index += fv;
-        }
 
-        std::shared_ptr<Material> material;
-        if (mat)
-        {
-            std::string ambient_texname = (mat->ambient_texname.empty()
-                ? std::string()
-                : dirname + mat->ambient_texname);
-            std::string diffuse_texname = (mat->diffuse_texname.empty()
-                ? std::string()
-                : dirname + mat->diffuse_texname);
-            std::string specular_texname = (mat->specular_texname.empty()
-                ? std::string()
-                : dirname + mat->specular_texname);
-            std::string bump_texname = (mat->bump_texname.empty()
-                ? std::string()
-                : dirname + mat->bump_texname);
+            if (has_txcds && idx.texcoord_index >= 0)
+            {
+                vert.texcoord = glm::vec2(
+                    attrib.texcoords[2 * idx.texcoord_index + 0],
+                    attrib.texcoords[2 * idx.texcoord_index + 1]);
+            }
 
-            material = Material::Create(
-                glm::vec4(mat->ambient[0], mat->ambient[1], mat->ambient[2], 1.0f),
-                glm::vec4(mat->diffuse[0], mat->diffuse[1], mat->diffuse[2], 1.0f),
-                glm::vec4(mat->specular[0], mat->specular[1], mat->specular[2], 1.0f),
-                mat->shininess, mat->dissolve,
-                ambient_texname,
-                diffuse_texname,
-                specular_texname,
-                bump_texname
-            );
+            GLuint index = (GLuint)group.vertices.size();
+            unique.emplace(key, index);
+            group.vertices.push_back(vert);
+            group.indices.push_back(index);
         }
-        AddRenderGroup(material, GL_TRIANGLES, verts, norms, txcds);
+
+        group.vertices.shrink_to_fit();
+
+        DuskLogVerbose("Shape '%s' has %zu unique vertices for %zu indices",
+                       shape.name.c_str(), group.vertices.size(), group.indices.size());
     }
 
     return true;
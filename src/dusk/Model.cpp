@@ -9,11 +9,10 @@ namespace dusk {
 
 Model::Model(Shader * shader)
     : _shader(shader)
-    , _baseTransform(1)
-    , _transform(1)
-    , _position(0)
-    , _rotation(0)
-    , _scale(1)
+    , _transformVersion(~0u)
+    , _cameraVersion(~0u)
+    , _transformPool(App::GetInst()->GetTransformPool())
+    , _transformHandle(_transformPool->Allocate(TransformPool::Order::SRT))
 {
     memset(&_shaderData, 0, sizeof(_shaderData));
     Shader::AddData("DuskTransformData", &_shaderData, sizeof(_shaderData));
@@ -27,7 +26,7 @@ Model::Model(Shader * shader)
 
 Model::~Model()
 {
-
+    _transformPool->Free(_transformHandle);
 }
 
 std::unique_ptr<Model> Model::Parse(nlohmann::json & data)
@@ -49,7 +48,7 @@ std::unique_ptr<Model> Model::Clone()
 {
     std::unique_ptr<Model> model(new Model(_shader));
 
-    model->SetBaseTransform(_baseTransform);
+    model->SetBaseTransform(_transformPool->GetBase(_transformHandle));
     model->SetPosition(GetPosition());
     model->SetRotation(GetRotation());
     model->SetScale(GetScale());
@@ -67,58 +66,68 @@ void Model::AddMesh(std::shared_ptr<Mesh> mesh)
     _meshes.push_back(mesh);
 }
 
-glm::mat4 Model::GetTransform()
+void Model::SetBaseTransform(const glm::mat4& baseTransform)
 {
-    _transform = _baseTransform;
-    _transform = glm::scale(_transform, _scale);
-    _transform = glm::rotate(_transform, _rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
-    _transform = glm::rotate(_transform, _rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
-    _transform = glm::rotate(_transform, _rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
-    _transform = glm::translate(_transform, _position);
-
-    return _transform;
+    _transformPool->SetBase(_transformHandle, baseTransform);
 }
 
-void Model::SetBaseTransform(const glm::mat4& baseTransform)
+void Model::SetParentTransform(unsigned int parent)
 {
-    _baseTransform = baseTransform;
+    _transformPool->SetParent(_transformHandle, parent);
 }
 
 void Model::SetPosition(const glm::vec3& pos)
 {
-    _position = pos;
+    _transformPool->SetPosition(_transformHandle, pos);
 }
 
 void Model::SetRotation(const glm::vec3& rot)
 {
-    _rotation = rot;
+    _transformPool->SetRotation(_transformHandle, rot);
 }
 
 void Model::SetScale(const glm::vec3& scale)
 {
-    _scale = scale;
+    _transformPool->SetScale(_transformHandle, scale);
 }
 
 void Model::Update()
 {
-    // TODO: Move camera somewhere else
-    Camera * camera = App::GetInst()->GetScene()->GetCurrentCamera();
+    for (auto& mesh : _meshes)
+    {
+        mesh->Update();
+    }
+}
+
+void Model::UpdateBounds()
+{
+    const glm::mat4& world = _transformPool->GetWorld(_transformHandle);
 
-    _shaderData.model = GetTransform();
-    _shaderData.view = camera->GetView();
-    _shaderData.proj = camera->GetProjection();
-    _shaderData.mvp = _shaderData.proj * _shaderData.view * _shaderData.model;
+    _worldBounds = AABB();
+    for (auto& mesh : _meshes)
+    {
+        _worldBounds.Expand(mesh->GetBounds().Transform(world));
+    }
 }
 
-void Model::Render()
+void Model::Render(RenderQueue * queue)
 {
-    _shader->Bind();
+    // Only rebuild the matrices if we or the camera moved
+    unsigned int transformVersion = _transformPool->GetRenderVersion(_transformHandle);
+    if (transformVersion != _transformVersion || queue->GetCameraVersion() != _cameraVersion)
+    {
+        _shaderData.model = _transformPool->GetRenderWorld(_transformHandle);
+        _shaderData.view = queue->GetView();
+        _shaderData.proj = queue->GetProjection();
+        _shaderData.mvp = queue->GetViewProjection() * _shaderData.model;
 
-    Shader::UpdateData("DuskTransformData", &_shaderData, sizeof(_shaderData));
+        _transformVersion = transformVersion;
+        _cameraVersion = queue->GetCameraVersion();
+    }
 
     for (auto& mesh : _meshes)
     {
-        mesh->Render(_shader);
+        mesh->Render(queue, _shader, &_shaderData);
     }
 }
 
@@ -0,0 +1,327 @@
+#include "dusk/RenderQueue.hpp"
+
+#include <dusk/Log.hpp>
+#include <dusk/Shader.hpp>
+#include <dusk/Material.hpp>
+#include <dusk/Mesh.hpp>
+#include <algorithm>
+
+namespace dusk {
+
+RenderQueue::RenderQueue()
+    : _items()
+    , _entries()
+    , _batches()
+    , _instanceData()
+    , _glInstanceVBO(0)
+    , _instanceCapacity(0)
+    , _znear(0.1f)
+    , _zfar(1000.0f)
+    , _view(1)
+    , _proj(1)
+    , _viewProj(1)
+    , _cameraVersion(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+RenderQueue::~RenderQueue()
+{
+    glDeleteBuffers(1, &_glInstanceVBO);
+}
+
+void RenderQueue::Clear()
+{
+    _items.clear();
+    _entries.clear();
+}
+
+void RenderQueue::Add(const DrawItem& item)
+{
+    _entries.push_back({ MakeKey(item), (uint32_t)_items.size(), -1, -1 });
+    _items.push_back(item);
+}
+
+void RenderQueue::Sort()
+{
+    std::sort(_entries.begin(), _entries.end());
+}
+
+void RenderQueue::SetDepthRange(float znear, float zfar)
+{
+    _znear = znear;
+    _zfar = zfar;
+}
+
+void RenderQueue::SetCamera(const glm::mat4& view, const glm::mat4& proj)
+{
+    if (view == _view && proj == _proj)
+    {
+        return;
+    }
+
+    _view = view;
+    _proj = proj;
+    _viewProj = proj * view;
+    ++_cameraVersion;
+}
+
+uint64_t RenderQueue::MakeKey(const DrawItem& item) const
+{
+    //  63-52     51-36      35-24     23-12  11-0
+    // [shader | material | texture | VAO | depth]
+    uint64_t shader = (item.shader ? item.shader->GetGLProgram() : 0) & 0xFFF;
+    uint64_t material = (item.material ? item.material->GetSortId() : 0) & 0xFFFF;
+
+    uint64_t texture = 0;
+    if (item.material)
+    {
+        Texture * map = item.material->GetMap(Material::TextureID::DIFFUSE);
+        texture = (map ? map->GetGLID() : 0) & 0xFFF;
+    }
+
+    uint64_t vao = item.glVAO & 0xFFF;
+
+    // The w component of the clip-space origin is the view depth
+    float depth = 0.0f;
+    if (item.transform && _zfar > _znear)
+    {
+        depth = (item.transform->mvp[3][3] - _znear) / (_zfar - _znear);
+        depth = std::min(std::max(depth, 0.0f), 1.0f);
+    }
+
+    return (shader << 52) | (material << 36) | (texture << 24) | (vao << 12)
+        | (uint64_t)(depth * 0xFFF);
+}
+
+bool RenderQueue::CanBatch(const DrawItem& lhs, const DrawItem& rhs)
+{
+    return lhs.shader == rhs.shader
+        && lhs.material == rhs.material
+        && lhs.glVAO == rhs.glVAO
+        && lhs.drawMode == rhs.drawMode
+        && lhs.indexCount == rhs.indexCount;
+}
+
+bool RenderQueue::WriteUniforms()
+{
+    size_t transformSize = _uniformRing.Align(sizeof(TransformData));
+    size_t materialSize = _uniformRing.Align(sizeof(MaterialData));
+
+    if (!_uniformRing.BeginFrame(_entries.size() * (transformSize + materialSize)))
+    {
+        return false;
+    }
+
+    _batches.clear();
+    _instanceData.clear();
+
+    TransformData * lastTransform = nullptr;
+    Material * lastMaterial = nullptr;
+    GLintptr transformOffset = -1;
+    GLintptr materialOffset = -1;
+
+    // Write everything for the frame up front, each block only once in a row
+    for (uint32_t i = 0; i < (uint32_t)_entries.size(); ++i)
+    {
+        SortEntry& entry = _entries[i];
+        const DrawItem& item = _items[entry.index];
+
+        bool instanced = (item.shader && item.shader->IsInstanced());
+
+        // Sorting already put identical shader/material/VAO runs next to each other
+        if (instanced && !_batches.empty())
+        {
+            Batch& batch = _batches.back();
+            if (batch.instanced && CanBatch(_items[_entries[batch.first].index], item))
+            {
+                ++batch.count;
+                _instanceData.push_back(item.transform->model);
+                continue;
+            }
+        }
+
+        if (item.transform != lastTransform)
+        {
+            transformOffset = _uniformRing.Write(item.transform, sizeof(TransformData));
+            lastTransform = item.transform;
+        }
+        entry.transformOffset = transformOffset;
+
+        if (item.material && item.material != lastMaterial)
+        {
+            materialOffset = _uniformRing.Write(&item.material->GetShaderData(), sizeof(MaterialData));
+            lastMaterial = item.material;
+        }
+        entry.materialOffset = materialOffset;
+
+        _batches.push_back({ i, 1, instanced, (GLintptr)(_instanceData.size() * sizeof(glm::mat4)) });
+        if (instanced)
+        {
+            _instanceData.push_back(item.transform->model);
+        }
+    }
+
+    _stats.uniformBytes = _uniformRing.GetBytesWritten();
+
+    _uniformRing.EndWrite();
+
+    WriteInstances();
+
+    return true;
+}
+
+void RenderQueue::WriteInstances()
+{
+    if (_instanceData.empty())
+    {
+        return;
+    }
+
+    if (0 == _glInstanceVBO)
+    {
+        glGenBuffers(1, &_glInstanceVBO);
+    }
+
+    size_t size = _instanceData.size() * sizeof(glm::mat4);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _glInstanceVBO);
+    if (size > _instanceCapacity)
+    {
+        _instanceCapacity = std::max(size, _instanceCapacity * 2);
+    }
+
+    // Orphan last frame's storage so the upload never waits on the GPU
+    glBufferData(GL_ARRAY_BUFFER, _instanceCapacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, _instanceData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void RenderQueue::Submit()
+{
+    static const Material::TextureID maps[] = {
+        Material::TextureID::AMBIENT,
+        Material::TextureID::DIFFUSE,
+        Material::TextureID::SPECULAR,
+        Material::TextureID::BUMP,
+    };
+
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.items = (unsigned int)_items.size();
+
+    if (_entries.empty() || !WriteUniforms())
+    {
+        return;
+    }
+
+    int transformIndex = Shader::GetDataIndex("DuskTransformData");
+    int materialIndex = Shader::GetDataIndex("DuskMaterialData");
+
+    Shader * boundShader = nullptr;
+    Material * boundMaterial = nullptr;
+    GLintptr boundTransform = -1;
+    GLuint boundVAO = 0;
+    GLuint boundTextures[] = { 0, 0, 0, 0 };
+
+    unsigned int naiveBinds = 0;
+
+    for (const Batch& batch : _batches)
+    {
+        const SortEntry& entry = _entries[batch.first];
+        const DrawItem& item = _items[entry.index];
+
+        // Shader, transform and VAO per item, plus the material and its maps
+        naiveBinds += 3 * batch.count;
+
+        if (item.shader != boundShader)
+        {
+            item.shader->Bind();
+            Material::BindSamplers(item.shader);
+
+            boundShader = item.shader;
+            ++_stats.shaderBinds;
+        }
+
+        if (entry.transformOffset != boundTransform && entry.transformOffset >= 0 && transformIndex >= 0)
+        {
+            _uniformRing.BindRange(transformIndex, entry.transformOffset, sizeof(TransformData));
+
+            boundTransform = entry.transformOffset;
+            ++_stats.transformBinds;
+        }
+
+        if (item.material)
+        {
+            naiveBinds += batch.count;
+            if (item.material != boundMaterial && entry.materialOffset >= 0 && materialIndex >= 0)
+            {
+                _uniformRing.BindRange(materialIndex, entry.materialOffset, sizeof(MaterialData));
+
+                boundMaterial = item.material;
+                ++_stats.materialBinds;
+            }
+
+            for (Material::TextureID id : maps)
+            {
+                Texture * map = item.material->GetMap(id);
+                if (!map)
+                {
+                    continue;
+                }
+
+                naiveBinds += batch.count;
+                GLuint glID = map->GetGLID();
+                if (glID != boundTextures[id])
+                {
+                    glActiveTexture(GL_TEXTURE0 + id);
+                    glBindTexture(GL_TEXTURE_2D, glID);
+
+                    boundTextures[id] = glID;
+                    ++_stats.textureBinds;
+                }
+            }
+        }
+
+        if (item.glVAO != boundVAO)
+        {
+            glBindVertexArray(item.glVAO);
+
+            boundVAO = item.glVAO;
+            ++_stats.vaoBinds;
+        }
+
+        if (batch.instanced)
+        {
+            // GL 3.3 has no base instance, so point the matrix columns at this batch
+            glBindBuffer(GL_ARRAY_BUFFER, _glInstanceVBO);
+            for (GLuint col = 0; col < 4; ++col)
+            {
+                GLuint attr = Mesh::AttrID::INSTANCE + col;
+                glEnableVertexAttribArray(attr);
+                glVertexAttribPointer(attr, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                    (GLvoid *)(batch.instanceOffset + col * sizeof(glm::vec4)));
+                glVertexAttribDivisor(attr, 1);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            glDrawElementsInstanced(item.drawMode, item.indexCount, item.indexType, NULL, batch.count);
+            ++_stats.instancedDrawCalls;
+        }
+        else
+        {
+            glDrawElements(item.drawMode, item.indexCount, item.indexType, NULL);
+        }
+        ++_stats.drawCalls;
+    }
+
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+
+    _uniformRing.EndFrame();
+
+    _stats.skippedBinds = naiveBinds - (_stats.shaderBinds + _stats.transformBinds +
+                                        _stats.materialBinds + _stats.textureBinds +
+                                        _stats.vaoBinds);
+}
+
+} // namespace dusk
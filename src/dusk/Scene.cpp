@@ -2,11 +2,15 @@
 
 #include <dusk/App.hpp>
 #include <dusk/Benchmark.hpp>
+#include <dusk/ScriptCommandBuffer.hpp>
+#include <algorithm>
 
 namespace dusk {
 
 Scene::Scene()
     : _currentCamera(nullptr)
+    , _visibleCount(0)
+    , _culledCount(0)
     , _actors()
 { }
 
@@ -70,6 +74,7 @@ Scene::~Scene()
 void Scene::AddActor(std::unique_ptr<Actor> actor)
 {
     actor->SetScene(this);
+    _unboundedActors.push_back(actor.get());
     _actors.push_back(std::move(actor));
 }
 
@@ -114,21 +119,235 @@ void Scene::Stop()
 
 void Scene::Update(const Event& event)
 {
+    DispatchEvent(Event((EventID)Events::UPDATE, event.GetData()));
+
+    // Scripts may spawn actors while we're iterating
+    for (size_t i = 0; i < _actors.size(); ++i)
+    {
+        _actors[i]->Update(event);
+    }
+
+    UpdateParallelScripts(event);
+
+    for (ModelComponent * component : _modelComponents)
+    {
+        component->OnUpdate(event);
+    }
+
+    TransformPool * transformPool = App::GetInst()->GetTransformPool();
+    transformPool->Update();
+
+    // Only actors that actually moved need their bounds refit
+    for (unsigned int handle : transformPool->GetChanged())
+    {
+        Actor * actor = (Actor *)transformPool->GetOwner(handle);
+        if (actor)
+        {
+            actor->UpdateBounds();
+        }
+    }
+
+    // Cameras follow their actor's transform from this frame
+    for (CameraComponent * component : _cameraComponents)
+    {
+        component->OnUpdate(event);
+    }
+
     for (auto& camera : _cameras)
     {
         camera->Update();
     }
+}
 
-    DispatchEvent(Event((EventID)Events::UPDATE, event.GetData()));
+void Scene::UpdateParallelScripts(const Event& event)
+{
+    size_t count = _parallelScripts.GetCount();
+    if (0 == count)
+    {
+        return;
+    }
+
+    ThreadPool * workers = App::GetInst()->GetWorkerPool();
+
+    // The calling thread takes the first chunk itself
+    size_t threads = workers->GetThreadCount();
+    size_t chunk = (count + threads) / (threads + 1);
+
+    for (size_t start = chunk; start < count; start += chunk)
+    {
+        size_t stop = std::min(start + chunk, count);
+        workers->Submit([this, &event, start, stop]() {
+            for (size_t i = start; i < stop; ++i)
+            {
+                _parallelScripts.Get(i)->OnParallelUpdate(event);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < chunk && i < count; ++i)
+    {
+        _parallelScripts.Get(i)->OnParallelUpdate(event);
+    }
+
+    workers->Wait();
+
+    // Same order every frame, so the last write to a transform always wins
+    for (ScriptComponent * component : _parallelScripts)
+    {
+        component->FlushCommands();
+    }
 }
 
 void Scene::Render(const Event& event)
 {
+    _renderQueue.Clear();
+
+    for (CameraComponent * component : _cameraComponents)
+    {
+        component->OnPreRender(event);
+    }
+
+    // Cameras move in update steps, like transforms
+    float alpha = App::GetInst()->GetInterpolationAlpha();
+    for (auto& camera : _cameras)
+    {
+        camera->Interpolate(alpha);
+    }
+
+    if (_currentCamera)
+    {
+        glm::vec2 clip = _currentCamera->GetClip();
+        _renderQueue.SetDepthRange(clip.x, clip.y);
+        _renderQueue.SetCamera(_currentCamera->GetView(), _currentCamera->GetProjection());
+    }
+
+    CullActors();
+
+    // Components submit draw items instead of drawing directly
+    for (void * actor : _visibleActors)
+    {
+        ((Actor *)actor)->Render(event);
+    }
+
+    for (Actor * actor : _unboundedActors)
+    {
+        actor->Render(event);
+    }
+
     DispatchEvent(Event((EventID)Events::RENDER));
+
+    _renderQueue.Sort();
+    _renderQueue.Submit();
+}
+
+void Scene::CullActors()
+{
+    _visibleActors.clear();
+
+    if (_currentCamera)
+    {
+        Frustum frustum = Frustum::FromMatrix(_renderQueue.GetViewProjection());
+        _bvh.QueryFrustum(frustum, _visibleActors);
+    }
+
+    _visibleCount = (unsigned int)(_visibleActors.size() + _unboundedActors.size());
+    _culledCount = (unsigned int)(_bvh.GetLeafCount() - _visibleActors.size());
+}
+
+void Scene::UpdateActorBounds(Actor * actor)
+{
+    const AABB& bounds = actor->GetWorldBounds();
+    int proxy = actor->GetBVHProxy();
+
+    if (bounds.IsValid())
+    {
+        if (BVH::NULL_NODE == proxy)
+        {
+            actor->SetBVHProxy(_bvh.Insert(bounds, actor));
+
+            auto it = std::find(_unboundedActors.begin(), _unboundedActors.end(), actor);
+            if (it != _unboundedActors.end())
+            {
+                std::swap(*it, _unboundedActors.back());
+                _unboundedActors.pop_back();
+            }
+        }
+        else
+        {
+            _bvh.Move(proxy, bounds);
+        }
+    }
+    else if (BVH::NULL_NODE != proxy)
+    {
+        _bvh.Remove(proxy);
+        actor->SetBVHProxy(BVH::NULL_NODE);
+        _unboundedActors.push_back(actor);
+    }
+}
+
+void Scene::RemoveActorBounds(Actor * actor)
+{
+    if (BVH::NULL_NODE != actor->GetBVHProxy())
+    {
+        _bvh.Remove(actor->GetBVHProxy());
+        actor->SetBVHProxy(BVH::NULL_NODE);
+    }
+
+    auto it = std::find(_unboundedActors.begin(), _unboundedActors.end(), actor);
+    if (it != _unboundedActors.end())
+    {
+        std::swap(*it, _unboundedActors.back());
+        _unboundedActors.pop_back();
+    }
+}
+
+void Scene::QueryRadius(const glm::vec3& center, float radius, std::vector<Actor *>& actors) const
+{
+    std::vector<void *> results;
+    _bvh.QueryRadius(center, radius, results);
+
+    for (void * actor : results)
+    {
+        actors.push_back((Actor *)actor);
+    }
+}
+
+Actor * Scene::Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, float * hitDist /*= nullptr*/) const
+{
+    return (Actor *)_bvh.Raycast(origin, dir, maxDist, hitDist);
 }
 
 void Scene::InitScripting()
 {
+    ScriptHost::AddBinding(&Scene::BindScripting);
+}
+
+void Scene::BindScripting(lua_State * L)
+{
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    dusk.new_usertype<Scene>("Scene",
+        "new", sol::no_constructor,
+        sol::base_classes, sol::bases<IEventDispatcher>(),
+        "Events", sol::var(lua.create_table_with(
+            "START", (EventID)Events::START,
+            "STOP", (EventID)Events::STOP,
+            "UPDATE", (EventID)Events::UPDATE,
+            "RENDER", (EventID)Events::RENDER)),
+        "GetCurrentCamera", &Scene::GetCurrentCamera,
+        "SetCurrentCamera", ScriptCommandBuffer::MainThreadOnly(&Scene::SetCurrentCamera, "Scene:SetCurrentCamera"),
+        "QueryRadius", [](const Scene& scene, const glm::vec3& center, float radius) {
+            std::vector<Actor *> actors;
+            scene.QueryRadius(center, radius, actors);
+            return sol::as_table(std::move(actors));
+        },
+        "Raycast", [](const Scene& scene, const glm::vec3& origin, const glm::vec3& dir, sol::optional<float> maxDist) {
+            float hitDist = 0.0f;
+            Actor * actor = scene.Raycast(origin, dir, maxDist.value_or(FLT_MAX), &hitDist);
+            // A miss pushes nil for the actor
+            return std::make_tuple(actor, hitDist);
+        });
 }
 
 } // namespace dusk
@@ -0,0 +1,275 @@
+#include "dusk/ScriptCache.hpp"
+
+#include <dusk/Log.hpp>
+#include <dusk/Util.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+
+namespace dusk {
+
+static const char CACHE_MAGIC[4] = { 'D', 'L', 'B', '2' };
+
+struct CacheHeader
+{
+    char magic[4];
+    int32_t version;
+    uint64_t hash;
+    int64_t size;
+};
+
+// FNV-1a
+static uint64_t Hash(const char * data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool ReadSource(const std::string& filename, std::string& source)
+{
+    FILE * fp = fopen(filename.c_str(), "rb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    char buffer[4096];
+    size_t count;
+
+    source.clear();
+    while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        source.append(buffer, count);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+ScriptCache::ScriptCache()
+    : _hitCount(0)
+    , _missCount(0)
+{
+}
+
+ScriptCache::~ScriptCache()
+{
+}
+
+void ScriptCache::SetDirectory(const std::string& directory)
+{
+    _directory = directory;
+    CleanSlashes(_directory);
+
+    if (!_directory.empty() && '/' != _directory.back())
+    {
+        _directory += '/';
+    }
+}
+
+int ScriptCache::LoadFile(lua_State * L, const std::string& filename)
+{
+    std::string path = filename;
+    CleanSlashes(path);
+
+    // Timestamps can't tell apart two saves within their resolution, so
+    // entries are matched on the contents
+    std::string source;
+    if (!ReadSource(path, source))
+    {
+        // Let Lua report the missing file
+        return luaL_loadfile(L, path.c_str());
+    }
+
+    std::string chunkname = "@" + path;
+    uint64_t hash = Hash(source.data(), source.size());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(path);
+    if (it != _entries.end())
+    {
+        Entry& entry = it->second;
+        if (entry.hash == hash && entry.size == (long long)source.size())
+        {
+            ++_hitCount;
+            return luaL_loadbufferx(L, entry.bytecode.data(), entry.bytecode.size(), chunkname.c_str(), "b");
+        }
+
+        _entries.erase(it);
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.size = (long long)source.size();
+
+    if (ReadEntry(path, entry))
+    {
+        int status = luaL_loadbufferx(L, entry.bytecode.data(), entry.bytecode.size(), chunkname.c_str(), "b");
+        if (LUA_OK == status)
+        {
+            ++_hitCount;
+            _entries.emplace(path, std::move(entry));
+            return status;
+        }
+
+        // Written by a different Lua build, recompile
+        lua_pop(L, 1);
+    }
+
+    ++_missCount;
+
+    // Compile what was hashed, the file may have changed again since. Like
+    // luaL_loadfile(), skip a UTF-8 BOM and a first line starting with #,
+    // keeping its newline so line numbers still match
+    size_t start = 0;
+    if (0 == source.compare(0, 3, "\xEF\xBB\xBF"))
+    {
+        start = 3;
+    }
+    if (start < source.size() && '#' == source[start])
+    {
+        start = std::min(source.find('\n', start), source.size());
+    }
+
+    int status = luaL_loadbufferx(L, source.data() + start, source.size() - start, chunkname.c_str(), nullptr);
+    if (LUA_OK != status)
+    {
+        return status;
+    }
+
+    entry.bytecode.clear();
+    if (0 != lua_dump(L, &ScriptCache::Writer, &entry.bytecode, 0))
+    {
+        DuskLogWarn("Failed to dump bytecode for '%s'", path.c_str());
+        return status;
+    }
+
+    WriteEntry(path, entry);
+    _entries.emplace(path, std::move(entry));
+
+    return status;
+}
+
+void ScriptCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _entries.clear();
+    _hitCount = 0;
+    _missCount = 0;
+}
+
+unsigned int ScriptCache::GetHitCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hitCount;
+}
+
+unsigned int ScriptCache::GetMissCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _missCount;
+}
+
+std::string ScriptCache::GetCachePath(const std::string& filename) const
+{
+    uint64_t hash = Hash(filename.data(), filename.size());
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.luac", (unsigned long long)hash);
+
+    return _directory + name;
+}
+
+bool ScriptCache::ReadEntry(const std::string& filename, Entry& entry) const
+{
+    if (_directory.empty())
+    {
+        return false;
+    }
+
+    std::string cachePath = GetCachePath(filename);
+    CacheHeader header;
+    long length;
+
+    FILE * fp = fopen(cachePath.c_str(), "rb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    if (1 != fread(&header, sizeof(header), 1, fp))
+        goto error;
+
+    if (0 != memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) || LUA_VERSION_NUM != header.version)
+        goto error;
+
+    if (header.hash != entry.hash || header.size != entry.size)
+        goto error;
+
+    fseek(fp, 0, SEEK_END);
+    length = ftell(fp) - (long)sizeof(header);
+    fseek(fp, sizeof(header), SEEK_SET);
+
+    if (length <= 0)
+        goto error;
+
+    entry.bytecode.resize((size_t)length);
+    if (1 != fread(&entry.bytecode[0], (size_t)length, 1, fp))
+        goto error;
+
+    fclose(fp);
+
+    return true;
+
+error:
+
+    fclose(fp);
+    entry.bytecode.clear();
+
+    return false;
+}
+
+void ScriptCache::WriteEntry(const std::string& filename, const Entry& entry) const
+{
+    if (_directory.empty())
+    {
+        return;
+    }
+
+    std::string cachePath = GetCachePath(filename);
+
+    CacheHeader header;
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = LUA_VERSION_NUM;
+    header.hash = entry.hash;
+    header.size = entry.size;
+
+    FILE * fp = fopen(cachePath.c_str(), "wb");
+    if (!fp)
+    {
+        DuskLogWarn("Failed to open script cache file '%s'", cachePath.c_str());
+        return;
+    }
+
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(entry.bytecode.data(), entry.bytecode.size(), 1, fp);
+
+    fclose(fp);
+}
+
+int ScriptCache::Writer(lua_State * L, const void * data, size_t size, void * userdata)
+{
+    static_cast<std::string *>(userdata)->append(static_cast<const char *>(data), size);
+    return 0;
+}
+
+} // namespace dusk
@@ -0,0 +1,35 @@
+#include "dusk/ScriptCommandBuffer.hpp"
+
+#include <dusk/TransformPool.hpp>
+
+namespace dusk {
+
+thread_local ScriptCommandBuffer * ScriptCommandBuffer::_Current = nullptr;
+
+void ScriptCommandBuffer::Push(Type type, unsigned int handle, const glm::vec3& value)
+{
+    _commands.push_back({ type, handle, value });
+}
+
+void ScriptCommandBuffer::Flush(TransformPool * transformPool)
+{
+    for (const Command& command : _commands)
+    {
+        switch (command.type)
+        {
+        case Type::SET_POSITION:
+            transformPool->SetPosition(command.handle, command.value);
+            break;
+        case Type::SET_ROTATION:
+            transformPool->SetRotation(command.handle, command.value);
+            break;
+        case Type::SET_SCALE:
+            transformPool->SetScale(command.handle, command.value);
+            break;
+        }
+    }
+
+    _commands.clear();
+}
+
+} // namespace dusk
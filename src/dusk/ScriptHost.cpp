@@ -1,100 +1,598 @@
 #include "dusk/ScriptHost.hpp"
 
 #include <dusk/Log.hpp>
+#include <dusk/App.hpp>
+#include <dusk/Benchmark.hpp>
+#include <dusk/ScriptScheduler.hpp>
+#include <dusk/ScriptProfiler.hpp>
+
+#include <algorithm>
+#include <chrono>
 
 namespace dusk {
 
 std::vector<ScriptHost *> ScriptHost::_ScriptHosts;
 std::unordered_map<std::string, lua_CFunction> ScriptHost::_Functions;
+std::vector<ScriptHost::BindFunction> ScriptHost::_Bindings;
 
-ScriptHost::ScriptHost()
-{
-    _ScriptHosts.push_back(this);
+lua_State * ScriptHost::_SharedState = nullptr;
+unsigned int ScriptHost::_SharedCount = 0;
 
-    _luaState = luaL_newstate();
-    if (!_luaState)
+thread_local int ScriptHost::_CurrentEnv = LUA_NOREF;
+
+int ScriptHost::_NextEnvRef = 1;
+std::unordered_set<int> ScriptHost::_LiveEnvs;
+
+// Registry table of environments by id
+static const char * ENV_TABLE = "dusk_envs";
+
+std::unordered_map<lua_State *, ScriptHost::StateInfo> ScriptHost::_States;
+unsigned int ScriptHost::_NextStateSerial = 1;
+
+unsigned int ScriptHost::_ReloadSerial = 0;
+
+const size_t ScriptHost::GC_LIMIT_FACTOR;
+const size_t ScriptHost::GC_MIN_BASELINE;
+const int ScriptHost::GC_STEP_SIZE;
+
+double ScriptHost::_GCBudget = 1.0;
+double ScriptHost::_GCTime = 0.0;
+unsigned int ScriptHost::_GCCycleCount = 0;
+size_t ScriptHost::_GCRotation = 0;
+
+ScriptCache ScriptHost::_Cache;
+
+static lua_State * CreateState()
+{
+    lua_State * L = luaL_newstate();
+    if (!L)
     {
         DuskLogError("Failed to create Lua state");
-        return;
+        return nullptr;
     }
 
-    luaL_openlibs(_luaState);
+    luaL_openlibs(L);
+
+    return L;
+}
+
+ScriptHost::ScriptHost(bool shared /*= false*/)
+    : _shared(shared)
+    , _luaState(nullptr)
+    , _envRef(LUA_NOREF)
+    , _loadTime(0.0)
+    , _memoryUsage(0)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (_shared && _SharedState)
+    {
+        _luaState = _SharedState;
+    }
+    else
+    {
+        _luaState = CreateState();
+        if (!_luaState)
+        {
+            return;
+        }
+
+        for (const auto& it : _Functions)
+        {
+            lua_register(_luaState, it.first.c_str(), it.second);
+        }
+
+        lua_newtable(_luaState);
+        lua_setglobal(_luaState, "Dusk");
+
+        BindCoreTypes(_luaState);
+        for (BindFunction bind : _Bindings)
+        {
+            bind(_luaState);
+        }
+
+        InstallSearcher(_luaState);
+
+        // Collection is driven by StepGC() instead of by allocations
+        lua_gc(_luaState, LUA_GCSTOP, 0);
+
+        _States[_luaState] = { _NextStateSerial++, GC_MIN_BASELINE, 0.0, false };
+
+        GetProfiler().Attach(_luaState);
+
+        // Only the first shared host pays for this
+        if (_shared)
+        {
+            _SharedState = _luaState;
+        }
+        else
+        {
+            _ScriptHosts.push_back(this);
+        }
 
-    for (const auto& it : _Functions)
+        // Load Dusk-Lua library
+        RunFile("assets/scripts/dusk/Dusk.lua");
+    }
+
+    if (_shared)
     {
-        lua_register(_luaState, it.first.c_str(), it.second);
+        ++_SharedCount;
+
+        // setmetatable({ }, { __index = _G })
+        lua_newtable(_luaState);
+        lua_newtable(_luaState);
+        lua_pushglobaltable(_luaState);
+        lua_setfield(_luaState, -2, "__index");
+        lua_setmetatable(_luaState, -2);
+
+        // Registry references get reused, listeners and coroutines that
+        // outlive us must not end up in another script's environment
+        _envRef = _NextEnvRef++;
+        _LiveEnvs.insert(_envRef);
+
+        luaL_getsubtable(_luaState, LUA_REGISTRYINDEX, ENV_TABLE);
+        lua_insert(_luaState, -2);
+        lua_rawseti(_luaState, -2, _envRef);
+        lua_pop(_luaState, 1);
     }
-    
-    // Load Dusk-Lua library
-    RunFile("assets/scripts/dusk/Dusk.lua");
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::high_resolution_clock::now() - start;
+    _loadTime = elapsed.count();
 }
 
 ScriptHost::~ScriptHost()
 {
-    auto it = std::find(_ScriptHosts.begin(), _ScriptHosts.end(), this);
-    if (it != _ScriptHosts.end())
+    if (!_luaState)
     {
-        std::swap(*it, _ScriptHosts.back());
-        _ScriptHosts.pop_back();
+        return;
     }
 
-    if (_luaState)
+    GetScheduler().StopAll(_luaState, _envRef);
+
+    for (const WatchedFile& file : _files)
+    {
+        App::GetInst()->GetFileWatcher()->Unwatch(file.watch);
+    }
+
+    if (_shared)
     {
-        lua_close(_luaState);
-        _luaState = nullptr;
+        luaL_getsubtable(_luaState, LUA_REGISTRYINDEX, ENV_TABLE);
+        lua_pushnil(_luaState);
+        lua_rawseti(_luaState, -2, _envRef);
+        lua_pop(_luaState, 1);
+
+        _LiveEnvs.erase(_envRef);
+        _envRef = LUA_NOREF;
+
+        if (--_SharedCount > 0)
+        {
+            _luaState = nullptr;
+            return;
+        }
+
+        _SharedState = nullptr;
     }
+    else
+    {
+        auto it = std::find(_ScriptHosts.begin(), _ScriptHosts.end(), this);
+        if (it != _ScriptHosts.end())
+        {
+            std::swap(*it, _ScriptHosts.back());
+            _ScriptHosts.pop_back();
+        }
+    }
+
+    _States.erase(_luaState);
+
+    lua_close(_luaState);
+    _luaState = nullptr;
 }
 
 bool ScriptHost::RunFile(const std::string& filename)
 {
-    int status = luaL_loadfile(_luaState, filename.c_str());
-    if (status)
-        goto error;
+    if (!Run(filename, _Cache.LoadFile(_luaState, filename)))
+    {
+        return false;
+    }
 
-    DuskLogInfo("Running script '%s'", filename.c_str());
+    DuskLogPerf("Script '%s' took %.3f ms and %.1f KB%s", filename.c_str(),
+        _loadTime, _memoryUsage / 1024.0f, (_shared ? " in the shared state" : ""));
 
-    // sets the error callback to 0, this means errors will be pushed onto the stack
-    status = lua_pcall(_luaState, 0, LUA_MULTRET, 0);
+    // The library is run into the shared state before any environment
+    // exists, and can't be run again the same way
+    bool watch = (!_shared || LUA_NOREF != _envRef) && App::GetInst();
 
-    if (status)
-        goto error;
+    for (const WatchedFile& file : _files)
+    {
+        watch &= (file.filename != filename);
+    }
+
+    if (watch)
+    {
+        FileWatcher::WatchID id = App::GetInst()->GetFileWatcher()->Watch(filename, [this](const std::string& changed) {
+            ReloadFile(changed);
+        });
+        _files.push_back({ filename, id });
+    }
 
     return true;
+}
 
-error:
+bool ScriptHost::ReloadFile(const std::string& filename)
+{
+    DuskBenchStart();
 
-    // get error message from stack
-    DuskLogError("Failed to run script '%s', %s", filename.c_str(), lua_tostring(_luaState, -1));
-    // remove error message
-    lua_pop(_luaState, 1);
+    int prevEnv = _CurrentEnv;
+    _CurrentEnv = _envRef;
 
-    return false;
+    PushGlobal(_luaState, "OnUnload");
+    if (lua_isfunction(_luaState, -1))
+    {
+        Call(_luaState, 0, 0);
+    }
+    else
+    {
+        lua_pop(_luaState, 1);
+    }
+
+    _CurrentEnv = prevEnv;
+
+    // Listeners added by name pick up the new functions
+    ++_ReloadSerial;
+
+    bool success = Run(filename, _Cache.LoadFile(_luaState, filename));
+
+    DuskBenchEnd("ScriptHost::ReloadFile()");
+    return success;
 }
 
 bool ScriptHost::RunString(const std::string& code)
 {
-    int status = luaL_loadbuffer(_luaState, code.c_str(), code.size(), NULL);
+    return Run("string", luaL_loadbuffer(_luaState, code.c_str(), code.size(), NULL));
+}
+
+bool ScriptHost::Run(const std::string& name, int loadStatus)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t memoryBefore = GetLuaMemory(_luaState);
+
+    int prevEnv = _CurrentEnv;
+    int handler;
+    int status = loadStatus;
     if (status)
         goto error;
 
-    // sets the error callback to 0, this means errors will be pushed onto the stack
-    status = lua_pcall(_luaState, 0, LUA_MULTRET, 0);
+    if (LUA_NOREF != _envRef)
+    {
+        // A main chunk's only upvalue is _ENV
+        PushEnv(_luaState, _envRef);
+        lua_setupvalue(_luaState, -2, 1);
+    }
+
+    DuskLogInfo("Running script '%s'", name.c_str());
+
+    _CurrentEnv = _envRef;
+
+    // errors are pushed onto the stack with a traceback
+    handler = lua_gettop(_luaState);
+    lua_pushcfunction(_luaState, &ScriptHost::Script_Traceback);
+    lua_insert(_luaState, handler);
+
+    GetProfiler().BeginCall(name);
+    status = lua_pcall(_luaState, 0, LUA_MULTRET, handler);
+    GetProfiler().EndCall();
+
+    lua_remove(_luaState, handler);
+
+    _CurrentEnv = prevEnv;
 
     if (status)
         goto error;
 
+    {
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+        _loadTime += elapsed.count();
+
+        size_t memoryAfter = GetLuaMemory(_luaState);
+        _memoryUsage += (memoryAfter > memoryBefore ? memoryAfter - memoryBefore : 0);
+    }
+
     return true;
 
 error:
 
     // get error message from stack
-    DuskLogError("Failed to run script %s", lua_tostring(_luaState, -1));
+    DuskLogError("Failed to run script '%s', %s", name.c_str(), lua_tostring(_luaState, -1));
     // remove error message
     lua_pop(_luaState, 1);
 
     return false;
 }
 
+void ScriptHost::SetGlobal(const std::string& name, lua_Integer value)
+{
+    if (LUA_NOREF == _envRef)
+    {
+        lua_pushinteger(_luaState, value);
+        lua_setglobal(_luaState, name.c_str());
+        return;
+    }
+
+    PushEnv(_luaState, _envRef);
+    lua_pushinteger(_luaState, value);
+    lua_setfield(_luaState, -2, name.c_str());
+    lua_pop(_luaState, 1);
+}
+
+ScriptScheduler& ScriptHost::GetScheduler()
+{
+    static ScriptScheduler scheduler;
+    return scheduler;
+}
+
+ScriptProfiler& ScriptHost::GetProfiler()
+{
+    static ScriptProfiler profiler;
+    return profiler;
+}
+
+void ScriptHost::PushGlobal(lua_State * L, const char * name)
+{
+    if (LUA_NOREF == _CurrentEnv)
+    {
+        lua_getglobal(L, name);
+        return;
+    }
+
+    PushEnv(L, _CurrentEnv);
+    if (!lua_istable(L, -1))
+    {
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        return;
+    }
+
+    lua_getfield(L, -1, name);
+    lua_remove(L, -2);
+}
+
+void ScriptHost::PushEnv(lua_State * L, int envRef)
+{
+    luaL_getsubtable(L, LUA_REGISTRYINDEX, ENV_TABLE);
+    lua_rawgeti(L, -1, envRef);
+    lua_remove(L, -2);
+}
+
+void ScriptHost::BindCoreTypes(lua_State * L)
+{
+    sol::state_view lua(L);
+    sol::table dusk = lua["Dusk"];
+
+    ScriptScheduler::BindScripting(L);
+
+    // Passed by value, so getters don't hand out pointers into C++ objects
+    dusk.new_usertype<glm::vec3>("Vec3",
+        sol::constructors<glm::vec3(), glm::vec3(float), glm::vec3(float, float, float)>(),
+        "x", &glm::vec3::x,
+        "y", &glm::vec3::y,
+        "z", &glm::vec3::z,
+        "Length", [](const glm::vec3& v) { return glm::length(v); },
+        "Normalize", [](const glm::vec3& v) { return glm::normalize(v); },
+        "Dot", [](const glm::vec3& a, const glm::vec3& b) { return glm::dot(a, b); },
+        "Cross", [](const glm::vec3& a, const glm::vec3& b) { return glm::cross(a, b); },
+        sol::meta_function::addition, [](const glm::vec3& a, const glm::vec3& b) { return a + b; },
+        sol::meta_function::subtraction, [](const glm::vec3& a, const glm::vec3& b) { return a - b; },
+        sol::meta_function::multiplication, [](const glm::vec3& v, float s) { return v * s; },
+        sol::meta_function::division, [](const glm::vec3& v, float s) { return v / s; },
+        sol::meta_function::unary_minus, [](const glm::vec3& v) { return -v; },
+        sol::meta_function::equal_to, [](const glm::vec3& a, const glm::vec3& b) { return a == b; },
+        sol::meta_function::to_string, [](const glm::vec3& v) {
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "(%g, %g, %g)", v.x, v.y, v.z);
+            return std::string(buffer);
+        });
+}
+
+void ScriptHost::InstallSearcher(lua_State * L)
+{
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchers");
+
+    // Run before the stock Lua file searcher, after the preload one
+    for (lua_Integer i = (lua_Integer)lua_rawlen(L, -1); i >= 2; --i)
+    {
+        lua_rawgeti(L, -1, i);
+        lua_rawseti(L, -2, i + 1);
+    }
+
+    lua_pushcfunction(L, &ScriptHost::Script_Searcher);
+    lua_rawseti(L, -2, 2);
+
+    lua_pop(L, 2);
+}
+
+int ScriptHost::Script_Searcher(lua_State * L)
+{
+    const char * name = luaL_checkstring(L, 1);
+
+    // package.searchpath(name, package.path)
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchpath");
+    lua_pushstring(L, name);
+    lua_getfield(L, -3, "path");
+    lua_call(L, 2, 2);
+
+    if (lua_isnil(L, -2))
+    {
+        // Let the other searchers explain why they failed too
+        return 1;
+    }
+
+    lua_pop(L, 1);
+    std::string filename = lua_tostring(L, -1);
+
+    if (LUA_OK != _Cache.LoadFile(L, filename))
+    {
+        return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s",
+            name, filename.c_str(), lua_tostring(L, -1));
+    }
+
+    lua_pushstring(L, filename.c_str());
+
+    return 2;
+}
+
+bool ScriptHost::Call(lua_State * L, int argCount, int resultCount)
+{
+    int handler = lua_gettop(L) - argCount;
+    lua_pushcfunction(L, &ScriptHost::Script_Traceback);
+    lua_insert(L, handler);
+
+    int status = lua_pcall(L, argCount, resultCount, handler);
+    lua_remove(L, handler);
+
+    if (LUA_OK != status)
+    {
+        DuskLogError("Lua error, %s", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return false;
+    }
+
+    return true;
+}
+
+int ScriptHost::Script_Traceback(lua_State * L)
+{
+    const char * msg = lua_tostring(L, 1);
+    luaL_traceback(L, L, (msg ? msg : "(error object is not a string)"), 1);
+
+    return 1;
+}
+
+unsigned int ScriptHost::GetStateSerial(lua_State * L)
+{
+    auto it = _States.find(L);
+    return (it == _States.end() ? 0 : it->second.serial);
+}
+
+void ScriptHost::StepGC()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    double elapsed = 0.0;
+
+    if (_States.empty())
+    {
+        _GCTime = 0.0;
+        return;
+    }
+
+    std::vector<std::pair<lua_State * const, StateInfo> *> states;
+    states.reserve(_States.size());
+    for (auto& it : _States)
+    {
+        states.push_back(&it);
+    }
+
+    // Whoever goes first gets any time the others leave, so take turns
+    size_t first = _GCRotation++ % states.size();
+    std::rotate(states.begin(), states.begin() + first, states.end());
+
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        lua_State * L = states[i]->first;
+        StateInfo& info = states[i]->second;
+        double stateStart = elapsed;
+
+        // An even split of what's left, so time a state doesn't use carries over
+        double share = (_GCBudget - elapsed) / (states.size() - i);
+
+        bool overLimit = (GetLuaMemory(L) > info.gcBaseline * GC_LIMIT_FACTOR);
+        if (overLimit)
+        {
+            if (!info.gcOverLimit)
+            {
+                DuskLogWarn("Lua heap grew past %zu KB, collecting with %zux the GC budget",
+                    info.gcBaseline * GC_LIMIT_FACTOR / 1024, GC_LIMIT_FACTOR);
+                info.gcOverLimit = true;
+            }
+
+            share = std::max(share, 0.0) + _GCBudget * GC_LIMIT_FACTOR;
+        }
+
+        bool finished = false;
+        while (!finished && elapsed - stateStart < share)
+        {
+            finished = (0 != lua_gc(L, LUA_GCSTEP, GC_STEP_SIZE));
+
+            std::chrono::duration<double, std::milli> duration =
+                std::chrono::high_resolution_clock::now() - start;
+            elapsed = duration.count();
+        }
+
+        info.gcTime += elapsed - stateStart;
+
+        if (finished)
+        {
+            size_t memory = GetLuaMemory(L);
+
+            DuskLogPerf("Lua GC cycle took %.3f ms in steps, %.1f KB in use",
+                info.gcTime, memory / 1024.0f);
+
+            ++_GCCycleCount;
+            info.gcBaseline = std::max(memory, GC_MIN_BASELINE);
+            info.gcTime = 0.0;
+            info.gcOverLimit = false;
+        }
+    }
+
+    _GCTime = elapsed;
+}
+
+std::vector<lua_State *> ScriptHost::GetStates()
+{
+    std::vector<lua_State *> states;
+    states.reserve(_States.size());
+
+    for (const auto& it : _States)
+    {
+        states.push_back(it.first);
+    }
+
+    return states;
+}
+
+std::string ScriptHost::DescribeFunction(lua_State * L, int index, const char * name /*= nullptr*/)
+{
+    lua_Debug ar;
+    char buffer[256];
+
+    lua_pushvalue(L, index);
+    if (!lua_getinfo(L, ">S", &ar))
+    {
+        return (name ? name : "?");
+    }
+
+    snprintf(buffer, sizeof(buffer), "%s (%s:%d)", (name ? name : "function"), ar.short_src, ar.linedefined);
+    return buffer;
+}
+
+size_t ScriptHost::GetTotalMemory()
+{
+    size_t total = 0;
+    for (const auto& it : _States)
+    {
+        total += GetLuaMemory(it.first);
+    }
+    return total;
+}
+
+size_t ScriptHost::GetLuaMemory(lua_State * L)
+{
+    return (size_t)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + (size_t)lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
 bool ScriptHost::AddFunction(const std::string& funcName, lua_CFunction function)
 {
     if (funcName.empty())
@@ -122,6 +620,39 @@ bool ScriptHost::AddFunction(const std::string& funcName, lua_CFunction function
         lua_register(it->GetLuaState(), funcName.c_str(), function);
     }
 
+    if (_SharedState)
+    {
+        lua_register(_SharedState, funcName.c_str(), function);
+    }
+
+    return true;
+}
+
+bool ScriptHost::AddBinding(BindFunction bind)
+{
+    if (!bind)
+    {
+        DuskLogError("Cannot register a null binding");
+        return false;
+    }
+
+    if (std::find(_Bindings.begin(), _Bindings.end(), bind) != _Bindings.end())
+    {
+        DuskLogWarn("Cannot register a binding twice");
+        return false;
+    }
+
+    _Bindings.push_back(bind);
+    for (const auto& it : _ScriptHosts)
+    {
+        bind(it->GetLuaState());
+    }
+
+    if (_SharedState)
+    {
+        bind(_SharedState);
+    }
+
     return true;
 }
 
@@ -0,0 +1,258 @@
+#include "dusk/ScriptProfiler.hpp"
+
+#include <dusk/Log.hpp>
+#include <dusk/ScriptHost.hpp>
+#include <dusk/ScriptScheduler.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace dusk {
+
+const int ScriptProfiler::SAMPLE_INTERVAL;
+
+ScriptProfiler::ScriptProfiler()
+    : _running(false)
+    , _mainThread(std::this_thread::get_id())
+    , _sampleCount(0)
+{
+}
+
+ScriptProfiler::~ScriptProfiler()
+{
+}
+
+void ScriptProfiler::Start()
+{
+    if (_running)
+    {
+        return;
+    }
+
+    _running = true;
+    _lastSample = Clock::now();
+
+    for (lua_State * L : ScriptHost::GetStates())
+    {
+        Attach(L);
+    }
+
+    // Hooks are per thread, coroutines that already exist don't see the above
+    for (lua_State * L : ScriptHost::GetScheduler().GetThreads())
+    {
+        Attach(L);
+    }
+
+    DuskLogInfo("Lua profiler started");
+}
+
+void ScriptProfiler::Stop()
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    _running = false;
+
+    for (lua_State * L : ScriptHost::GetStates())
+    {
+        lua_sethook(L, nullptr, 0, 0);
+    }
+
+    for (lua_State * L : ScriptHost::GetScheduler().GetThreads())
+    {
+        lua_sethook(L, nullptr, 0, 0);
+    }
+
+    DuskLogInfo("Lua profiler stopped after %u samples", _sampleCount);
+}
+
+void ScriptProfiler::Reset()
+{
+    _callTimes.clear();
+    _functionTimes.clear();
+    _lineTimes.clear();
+    _stacks.clear();
+    _sampleCount = 0;
+}
+
+void ScriptProfiler::Attach(lua_State * L)
+{
+    if (_running)
+    {
+        // Coroutines created from now on inherit the hook
+        lua_sethook(L, &ScriptProfiler::Hook, LUA_MASKCOUNT, SAMPLE_INTERVAL);
+    }
+}
+
+void ScriptProfiler::BeginCall(const std::string& label)
+{
+    if (!_running || !IsMainThread())
+    {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+
+    _calls.push_back({ label, now });
+    _lastSample = now;
+}
+
+void ScriptProfiler::EndCall()
+{
+    if (_calls.empty() || !IsMainThread())
+    {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    const Call& call = _calls.back();
+
+    std::chrono::duration<double, std::milli> elapsed = now - call.start;
+
+    Entry& entry = _callTimes[call.label];
+    entry.name = call.label;
+    ++entry.calls;
+    entry.total += elapsed.count();
+    entry.max = std::max(entry.max, elapsed.count());
+
+    _calls.pop_back();
+    _lastSample = now;
+}
+
+void ScriptProfiler::Hook(lua_State * L, lua_Debug * ar)
+{
+    ScriptProfiler& profiler = ScriptHost::GetProfiler();
+    if (profiler._running && !profiler._calls.empty() && profiler.IsMainThread())
+    {
+        profiler.Sample(L);
+    }
+}
+
+void ScriptProfiler::Sample(lua_State * L)
+{
+    Clock::time_point now = Clock::now();
+    std::chrono::duration<double, std::milli> elapsed = now - _lastSample;
+    _lastSample = now;
+
+    double weight = elapsed.count();
+
+    ++_sampleCount;
+
+    lua_Debug ar;
+    char buffer[256];
+    std::string line;
+
+    _frames.clear();
+    for (int level = 0; lua_getstack(L, level, &ar); ++level)
+    {
+        if (!lua_getinfo(L, "Sln", &ar))
+        {
+            break;
+        }
+
+        if (0 == level)
+        {
+            snprintf(buffer, sizeof(buffer), "%s:%d", ar.short_src, ar.currentline);
+            line = buffer;
+        }
+
+        snprintf(buffer, sizeof(buffer), "%s (%s:%d)",
+            (ar.name ? ar.name : "?"), ar.short_src, ar.linedefined);
+        _frames.push_back(buffer);
+    }
+
+    if (_frames.empty())
+    {
+        return;
+    }
+
+    // Root first, under the engine call that got us here
+    std::string stack = _calls.back().label;
+    for (auto it = _frames.rbegin(); it != _frames.rend(); ++it)
+    {
+        stack += ';';
+        stack += *it;
+    }
+    _stacks[stack] += weight * 1000.0;
+
+    for (size_t i = 0; i < _frames.size(); ++i)
+    {
+        // Recursive functions only count once towards their total
+        if (std::find(_frames.begin(), _frames.begin() + i, _frames[i]) != _frames.begin() + i)
+        {
+            continue;
+        }
+
+        Entry& entry = _functionTimes[_frames[i]];
+        entry.name = _frames[i];
+        ++entry.calls;
+        entry.total += weight;
+        if (0 == i)
+        {
+            entry.self += weight;
+        }
+    }
+
+    Entry& entry = _lineTimes[line];
+    entry.name = line;
+    ++entry.calls;
+    entry.total += weight;
+    entry.self += weight;
+}
+
+std::vector<ScriptProfiler::Entry> ScriptProfiler::GetCalls() const
+{
+    return Sorted(_callTimes);
+}
+
+std::vector<ScriptProfiler::Entry> ScriptProfiler::GetFunctions() const
+{
+    return Sorted(_functionTimes);
+}
+
+std::vector<ScriptProfiler::Entry> ScriptProfiler::GetLines() const
+{
+    return Sorted(_lineTimes);
+}
+
+std::vector<ScriptProfiler::Entry> ScriptProfiler::Sorted(const std::unordered_map<std::string, Entry>& entries)
+{
+    std::vector<Entry> sorted;
+    sorted.reserve(entries.size());
+
+    for (const auto& it : entries)
+    {
+        sorted.push_back(it.second);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) {
+        return a.total > b.total;
+    });
+
+    return sorted;
+}
+
+bool ScriptProfiler::ExportFolded(const std::string& filename) const
+{
+    FILE * fp = fopen(filename.c_str(), "w");
+    if (!fp)
+    {
+        DuskLogError("Failed to open '%s' for writing", filename.c_str());
+        return false;
+    }
+
+    for (const auto& it : _stacks)
+    {
+        fprintf(fp, "%s %llu\n", it.first.c_str(), (unsigned long long)(it.second + 0.5));
+    }
+
+    fclose(fp);
+
+    DuskLogInfo("Wrote %zu Lua stacks to '%s'", _stacks.size(), filename.c_str());
+
+    return true;
+}
+
+} // namespace dusk
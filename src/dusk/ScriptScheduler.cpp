@@ -0,0 +1,463 @@
+#include "dusk/ScriptScheduler.hpp"
+
+#include <dusk/Log.hpp>
+#include <dusk/ScriptHost.hpp>
+#include <dusk/ScriptProfiler.hpp>
+#include <dusk/ScriptCommandBuffer.hpp>
+
+namespace dusk {
+
+const unsigned int TimerWheel::SLOT_COUNT;
+const unsigned int ScriptScheduler::TICKS_PER_SECOND;
+const unsigned int ScriptScheduler::INVALID_TASK;
+
+void TimerWheel::Add(uint64_t deadline, unsigned int id, unsigned int serial)
+{
+    if (deadline <= _now)
+    {
+        deadline = _now + 1;
+    }
+
+    _slots[deadline % SLOT_COUNT].push_back({ deadline, id, serial });
+}
+
+// Wakes a coroutine waiting in WaitForEvent(). The dispatcher owns this, so
+// it's also destroyed if the dispatcher goes away first
+class WakeEventCallback : public IEventCallback
+{
+public:
+
+    WakeEventCallback(ScriptScheduler * scheduler, unsigned int index, unsigned int serial)
+        : _scheduler(scheduler)
+        , _index(index)
+        , _serial(serial)
+    { }
+
+    virtual ~WakeEventCallback()
+    {
+        _scheduler->WakeFromEvent(_index, _serial, false);
+    }
+
+    virtual void Invoke(const Event& event) override
+    {
+        _scheduler->WakeFromEvent(_index, _serial, true);
+    }
+
+private:
+
+    ScriptScheduler * _scheduler;
+    unsigned int _index;
+    unsigned int _serial;
+
+}; // class WakeEventCallback
+
+ScriptScheduler::ScriptScheduler()
+    : _current(INVALID_TASK)
+    , _frame(0)
+    , _time(0.0)
+    , _runningCount(0)
+    , _resumedCount(0)
+{
+}
+
+ScriptScheduler::~ScriptScheduler()
+{
+    // Every state is closed by now, nothing left to release
+}
+
+lua_Integer ScriptScheduler::Start(lua_State * L, int index, int argCount)
+{
+    luaL_checktype(L, index, LUA_TFUNCTION);
+
+    unsigned int taskIndex;
+    if (_freeTasks.empty())
+    {
+        taskIndex = (unsigned int)_tasks.size();
+        _tasks.emplace_back();
+    }
+    else
+    {
+        taskIndex = _freeTasks.back();
+        _freeTasks.pop_back();
+    }
+
+    // Threads belong to the main state, so they outlive the caller
+    lua_State * mainState;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, LUA_RIDX_MAINTHREAD);
+    mainState = lua_tothread(L, -1);
+    lua_pop(L, 1);
+
+    lua_State * thread = lua_newthread(L);
+    int threadRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+    Task& task = _tasks[taskIndex];
+    task.luaState = mainState;
+    task.stateSerial = ScriptHost::GetStateSerial(mainState);
+    task.thread = thread;
+    task.threadRef = threadRef;
+    task.envRef = ScriptHost::GetCurrentEnv();
+    task.wait = Wait::NONE;
+    task.live = true;
+    task.running = false;
+    task.stopping = false;
+    task.dispatcher = nullptr;
+    task.label = ScriptHost::DescribeFunction(L, index, "coroutine");
+
+    ++_runningCount;
+
+    lua_Integer handle = ((lua_Integer)task.generation << 32) | taskIndex;
+
+    // Function and arguments move to the new thread
+    lua_pushvalue(L, index);
+    lua_xmove(L, thread, 1);
+    for (int i = 0; i < argCount; ++i)
+    {
+        lua_pushvalue(L, index + 1 + i);
+    }
+    lua_xmove(L, thread, argCount);
+
+    Resume(taskIndex, argCount);
+
+    return handle;
+}
+
+void ScriptScheduler::Stop(lua_Integer handle)
+{
+    unsigned int index = (unsigned int)(handle & 0xFFFFFFFF);
+    unsigned int generation = (unsigned int)(handle >> 32);
+
+    if (index >= _tasks.size() || !_tasks[index].live || _tasks[index].generation != generation)
+    {
+        return;
+    }
+
+    Release(index);
+}
+
+void ScriptScheduler::StopAll(lua_State * L, int envRef)
+{
+    for (unsigned int index = 0; index < _tasks.size(); ++index)
+    {
+        const Task& task = _tasks[index];
+        if (task.live && task.luaState == L && task.envRef == envRef)
+        {
+            Release(index);
+        }
+    }
+}
+
+void ScriptScheduler::Update(double elapsed)
+{
+    ++_frame;
+    _time += elapsed;
+
+    auto wake = [this](unsigned int index, unsigned int serial) {
+        Wake(index, serial);
+    };
+
+    _frameWheel.Advance(_frame, wake);
+    _timeWheel.Advance((uint64_t)(_time * TICKS_PER_SECOND), wake);
+
+    // Anything woken while resuming waits for the next frame
+    _resuming.swap(_ready);
+    _resumedCount = 0;
+
+    for (const Wakeup& wakeup : _resuming)
+    {
+        Task& task = _tasks[wakeup.index];
+        if (!task.live || Wait::READY != task.wait || task.waitSerial != wakeup.serial)
+        {
+            continue;
+        }
+
+        int argCount = 0;
+        if (task.resumeArgs > 0)
+        {
+            lua_pushboolean(task.thread, task.eventFired);
+            argCount = 1;
+        }
+
+        ++_resumedCount;
+        Resume(wakeup.index, argCount);
+    }
+
+    _resuming.clear();
+}
+
+std::vector<lua_State *> ScriptScheduler::GetThreads() const
+{
+    std::vector<lua_State *> threads;
+    threads.reserve(_runningCount);
+
+    for (const Task& task : _tasks)
+    {
+        if (task.live)
+        {
+            threads.push_back(task.thread);
+        }
+    }
+
+    return threads;
+}
+
+ScriptScheduler::Task * ScriptScheduler::GetTask(lua_State * L, unsigned int * index /*= nullptr*/)
+{
+    // Only the innermost running task can be asking
+    if (INVALID_TASK == _current || _tasks[_current].thread != L)
+    {
+        return nullptr;
+    }
+
+    if (index)
+    {
+        *index = _current;
+    }
+
+    return &_tasks[_current];
+}
+
+unsigned int ScriptScheduler::BeginWait(unsigned int index, Wait wait)
+{
+    Task& task = _tasks[index];
+    task.wait = wait;
+    task.resumeArgs = 0;
+    return ++task.waitSerial;
+}
+
+void ScriptScheduler::Wake(unsigned int index, unsigned int serial)
+{
+    Task& task = _tasks[index];
+    if (!task.live || task.waitSerial != serial || Wait::NONE == task.wait || Wait::READY == task.wait)
+    {
+        return;
+    }
+
+    task.wait = Wait::READY;
+    _ready.push_back({ index, serial });
+}
+
+void ScriptScheduler::WakeFromEvent(unsigned int index, unsigned int serial, bool fired)
+{
+    if (index >= _tasks.size())
+    {
+        return;
+    }
+
+    Task& task = _tasks[index];
+    if (!task.live || task.waitSerial != serial || Wait::EVENT != task.wait)
+    {
+        return;
+    }
+
+    // Otherwise the dispatcher is destroying the listener itself
+    if (fired)
+    {
+        task.dispatcher->RemoveEventListener(task.listener);
+    }
+
+    task.dispatcher = nullptr;
+    task.resumeArgs = 1;
+    task.eventFired = fired;
+
+    Wake(index, serial);
+}
+
+void ScriptScheduler::Resume(unsigned int index, int argCount)
+{
+    // The state may have been closed while we were waiting
+    if (ScriptHost::GetStateSerial(_tasks[index].luaState) != _tasks[index].stateSerial)
+    {
+        Release(index);
+        return;
+    }
+
+    lua_State * thread = _tasks[index].thread;
+
+    int prevEnv = ScriptHost::GetCurrentEnv();
+    ScriptHost::SetCurrentEnv(_tasks[index].envRef);
+
+    _tasks[index].wait = Wait::NONE;
+    _tasks[index].running = true;
+
+    unsigned int prevCurrent = _current;
+    _current = index;
+
+    ScriptProfiler& profiler = ScriptHost::GetProfiler();
+
+    profiler.BeginCall(_tasks[index].label);
+    int status = lua_resume(thread, nullptr, argCount);
+    profiler.EndCall();
+
+    _current = prevCurrent;
+    ScriptHost::SetCurrentEnv(prevEnv);
+
+    // Starting coroutines from inside this one can grow _tasks
+    Task& task = _tasks[index];
+    task.running = false;
+
+    if (LUA_YIELD == status)
+    {
+        lua_settop(thread, 0);
+
+        if (task.stopping)
+        {
+            Release(index);
+        }
+        else if (Wait::NONE == task.wait)
+        {
+            // A plain coroutine.yield() waits one frame
+            _frameWheel.Add(_frame + 1, index, BeginWait(index, Wait::FRAMES));
+        }
+        return;
+    }
+
+    if (LUA_OK != status)
+    {
+        const char * msg = lua_tostring(thread, -1);
+        luaL_traceback(thread, thread, (msg ? msg : "(error object is not a string)"), 0);
+        DuskLogError("Coroutine failed, %s", lua_tostring(thread, -1));
+    }
+
+    Release(index);
+}
+
+void ScriptScheduler::Release(unsigned int index)
+{
+    Task& task = _tasks[index];
+    if (!task.live)
+    {
+        return;
+    }
+
+    // Can't pull the thread out from under lua_resume, Resume() finishes up
+    if (task.running)
+    {
+        task.stopping = true;
+        return;
+    }
+
+    if (Wait::EVENT == task.wait && task.dispatcher)
+    {
+        task.dispatcher->RemoveEventListener(task.listener);
+    }
+
+    if (ScriptHost::GetStateSerial(task.luaState) == task.stateSerial)
+    {
+        luaL_unref(task.luaState, LUA_REGISTRYINDEX, task.threadRef);
+    }
+
+    task.live = false;
+    task.wait = Wait::NONE;
+    task.thread = nullptr;
+    task.threadRef = LUA_NOREF;
+    task.dispatcher = nullptr;
+    ++task.generation;
+    ++task.waitSerial;
+
+    --_runningCount;
+    _freeTasks.push_back(index);
+}
+
+void ScriptScheduler::BindScripting(lua_State * L)
+{
+    lua_getglobal(L, "Dusk");
+
+    lua_pushcfunction(L, &ScriptScheduler::Script_StartCoroutine);
+    lua_setfield(L, -2, "StartCoroutine");
+    lua_pushcfunction(L, &ScriptScheduler::Script_StopCoroutine);
+    lua_setfield(L, -2, "StopCoroutine");
+    lua_pushcfunction(L, &ScriptScheduler::Script_WaitSeconds);
+    lua_setfield(L, -2, "WaitSeconds");
+    lua_pushcfunction(L, &ScriptScheduler::Script_WaitFrames);
+    lua_setfield(L, -2, "WaitFrames");
+    lua_pushcfunction(L, &ScriptScheduler::Script_WaitForEvent);
+    lua_setfield(L, -2, "WaitForEvent");
+
+    lua_pop(L, 1);
+}
+
+int ScriptScheduler::Script_StartCoroutine(lua_State * L)
+{
+    if (ScriptCommandBuffer::GetCurrent())
+    {
+        return luaL_error(L, "coroutines can't be started from a parallel script");
+    }
+
+    int argCount = lua_gettop(L) - 1;
+
+    lua_pushinteger(L, ScriptHost::GetScheduler().Start(L, 1, argCount));
+
+    return 1;
+}
+
+int ScriptScheduler::Script_StopCoroutine(lua_State * L)
+{
+    if (ScriptCommandBuffer::GetCurrent())
+    {
+        return luaL_error(L, "coroutines can't be stopped from a parallel script");
+    }
+
+    ScriptHost::GetScheduler().Stop(luaL_checkinteger(L, 1));
+
+    return 0;
+}
+
+int ScriptScheduler::Script_WaitSeconds(lua_State * L)
+{
+    ScriptScheduler& scheduler = ScriptHost::GetScheduler();
+    double seconds = luaL_checknumber(L, 1);
+
+    unsigned int index;
+    if (!scheduler.GetTask(L, &index))
+    {
+        return luaL_error(L, "Dusk.WaitSeconds must be called from Dusk.StartCoroutine");
+    }
+
+    uint64_t deadline = (uint64_t)((scheduler._time + seconds) * TICKS_PER_SECOND);
+    scheduler._timeWheel.Add(deadline, index, scheduler.BeginWait(index, Wait::SECONDS));
+
+    return lua_yield(L, 0);
+}
+
+int ScriptScheduler::Script_WaitFrames(lua_State * L)
+{
+    ScriptScheduler& scheduler = ScriptHost::GetScheduler();
+    lua_Integer frames = luaL_optinteger(L, 1, 1);
+
+    unsigned int index;
+    if (!scheduler.GetTask(L, &index))
+    {
+        return luaL_error(L, "Dusk.WaitFrames must be called from Dusk.StartCoroutine");
+    }
+
+    uint64_t deadline = scheduler._frame + (uint64_t)std::max<lua_Integer>(frames, 1);
+    scheduler._frameWheel.Add(deadline, index, scheduler.BeginWait(index, Wait::FRAMES));
+
+    return lua_yield(L, 0);
+}
+
+int ScriptScheduler::Script_WaitForEvent(lua_State * L)
+{
+    ScriptScheduler& scheduler = ScriptHost::GetScheduler();
+
+    sol::optional<IEventDispatcher *> dispatcher = sol::stack::check_get<IEventDispatcher *>(L, 1);
+    luaL_argcheck(L, dispatcher && dispatcher.value(), 1, "expected an event dispatcher");
+    EventID eventId = (EventID)luaL_checkinteger(L, 2);
+
+    unsigned int index;
+    if (!scheduler.GetTask(L, &index))
+    {
+        return luaL_error(L, "Dusk.WaitForEvent must be called from Dusk.StartCoroutine");
+    }
+
+    unsigned int serial = scheduler.BeginWait(index, Wait::EVENT);
+
+    Task& task = scheduler._tasks[index];
+    task.dispatcher = dispatcher.value();
+    task.listener = task.dispatcher->AddEventListener(eventId, new WakeEventCallback(&scheduler, index, serial));
+
+    // Resumed with true when the event fires, false if the dispatcher is destroyed
+    return lua_yield(L, 0);
+}
+
+} // namespace dusk
@@ -2,6 +2,7 @@
 
 #include <dusk/Log.hpp>
 #include <dusk/Benchmark.hpp>
+#include <dusk/App.hpp>
 
 #include <fstream>
 #include <sstream>
@@ -59,6 +60,11 @@ std::unique_ptr<Shader> Shader::Parse(nlohmann::json & data)
 
     std::unique_ptr<Shader> ptr(new Shader(files));
 
+    if (data.find("Instanced") != data.end())
+    {
+        ptr->SetInstanced(data["Instanced"]);
+    }
+
     for (const std::string& bindData : data["BindData"])
     {
         ptr->BindData(bindData);
@@ -70,30 +76,94 @@ std::unique_ptr<Shader> Shader::Parse(nlohmann::json & data)
 Shader::Shader(const std::vector<FileInfo>& files)
     : _files(files)
     , _glProgram(0)
+    , _instanced(false)
 {
-    LoadProgram();
+    _glProgram = LoadProgram();
+
+    WatchFiles();
 }
 
 Shader::~Shader()
 {
+    FileWatcher * watcher = App::GetInst()->GetFileWatcher();
+    for (FileWatcher::WatchID id : _watches)
+    {
+        watcher->Unwatch(id);
+    }
+
     glDeleteProgram(_glProgram);
     _glProgram = 0;
 }
 
-bool Shader::LoadProgram()
+bool Shader::Reload()
+{
+    DuskBenchStart();
+
+    GLuint program = LoadProgram();
+    if (0 == program)
+    {
+        DuskLogError("Failed to reload shader program %u, keeping the old one", _glProgram);
+        return false;
+    }
+
+    glDeleteProgram(_glProgram);
+    _glProgram = program;
+
+    // Uniform block bindings belong to the program
+    std::vector<std::string> boundData;
+    boundData.swap(_boundData);
+    for (const std::string& name : boundData)
+    {
+        BindData(name);
+    }
+
+    // Includes may have changed
+    WatchFiles();
+
+    DuskBenchEnd("Shader::Reload()");
+    return true;
+}
+
+void Shader::WatchFiles()
+{
+    FileWatcher * watcher = App::GetInst()->GetFileWatcher();
+
+    for (FileWatcher::WatchID id : _watches)
+    {
+        watcher->Unwatch(id);
+    }
+    _watches.clear();
+
+    auto reload = [this](const std::string&) { Reload(); };
+
+    for (const FileInfo& info : _files)
+    {
+        _watches.push_back(watcher->Watch(info.filename, reload));
+    }
+
+    for (const std::string& include : _includes)
+    {
+        _watches.push_back(watcher->Watch(include, reload));
+    }
+}
+
+GLuint Shader::LoadProgram()
 {
     std::vector<GLuint> shaderIds;
     GLint programLinked = GL_FALSE;
+    GLuint program = 0;
 
     if (_files.empty())
     {
         DuskLogWarn("Shader has no files");
-        return false;
+        return 0;
     }
 
-    _glProgram = glCreateProgram();
+    _includes.clear();
 
-    if (0 == _glProgram)
+    program = glCreateProgram();
+
+    if (0 == program)
     {
         DuskLogError("Failed to create shader program");
         goto error;
@@ -107,39 +177,38 @@ bool Shader::LoadProgram()
             DuskLogError("Failed to load shader program '%s'", info.filename.c_str());
             goto error;
         }
-        glAttachShader(_glProgram, shaderIds.back());
+        glAttachShader(program, shaderIds.back());
     }
 
-    glLinkProgram(_glProgram);
+    glLinkProgram(program);
 
-    glGetProgramiv(_glProgram, GL_LINK_STATUS, &programLinked);
+    glGetProgramiv(program, GL_LINK_STATUS, &programLinked);
     if (!programLinked)
     {
         DuskLogError("Failed to link shader program");
-        PrintShaderProgramLog(_glProgram);
+        PrintShaderProgramLog(program);
         goto error;
     }
 
     for (GLuint id : shaderIds)
     {
-        glDetachShader(_glProgram, id);
+        glDetachShader(program, id);
         glDeleteShader(id);
     }
 
-    return true;
+    return program;
 
 error:
 
     for (GLuint id : shaderIds)
     {
-        glDetachShader(_glProgram, id);
+        glDetachShader(program, id);
         glDeleteShader(id);
     }
 
-    glDeleteShader(_glProgram);
-    _glProgram = 0;
+    glDeleteProgram(program);
 
-    return false;
+    return 0;
 }
 
 void Shader::Bind()
@@ -174,7 +243,7 @@ GLuint Shader::LoadShader(const std::string& filename, GLuint type)
         goto error;
     }
 
-    if (!LoadFile(filename, buffer))
+    if (!LoadFile(filename, buffer, &_includes))
     {
         DuskLogError("Failed to open shader file '%s'", filename.c_str());
         goto error;
@@ -202,7 +271,7 @@ error:
     return 0;
 }
 
-bool Shader::LoadFile(const std::string& filename, std::string& buffer)
+bool Shader::LoadFile(const std::string& filename, std::string& buffer, std::vector<std::string> * includes /*= nullptr*/)
 {
     bool retval = true;
     std::string dirname = GetDirname(filename);
@@ -235,8 +304,13 @@ bool Shader::LoadFile(const std::string& filename, std::string& buffer)
                     goto error;
                 }
 
+                if (includes && std::find(includes->begin(), includes->end(), incFilename) == includes->end())
+                {
+                    includes->push_back(incFilename);
+                }
+
                 DuskLogInfo("Loading shader include '%s'", incFilename.c_str());
-                if (!LoadFile(incFilename, buffer))
+                if (!LoadFile(incFilename, buffer, includes))
                 {
                     DuskLogError("Failed to load include '%s'", incFilename.c_str());
                     goto error;
@@ -376,4 +450,16 @@ void Shader::UpdateData(const std::string& name, void * data, size_t size)
     }
 }
 
+int Shader::GetDataIndex(const std::string& name)
+{
+    const auto& it = _DataRecords.find(name);
+
+    if (it == _DataRecords.end())
+    {
+        return -1;
+    }
+
+    return it->second.index;
+}
+
 } // namespace dusk
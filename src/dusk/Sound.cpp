@@ -2,12 +2,38 @@
 
 #include <dusk/Log.hpp>
 #include <dusk/Benchmark.hpp>
+#include <dusk/App.hpp>
 
 namespace dusk
 {
 
+std::shared_ptr<Sound> Sound::Create(const std::string& filename)
+{
+    App * app = App::GetInst();
+    AssetId id = app->GetSoundIndex()->GetId(filename);
+    std::shared_ptr<Sound> ptr = app->GetSoundCache()->Get(id);
+    if (!ptr)
+    {
+        ptr.reset(new Sound(filename));
+        app->GetSoundCache()->Add(id, ptr);
+        app->GetAssetLoader()->Queue(ptr);
+    }
+    return ptr;
+}
+
 Sound::Sound(const std::string& filename)
+    : _filename(filename)
+    , _alBuffer(0)
+    , _alFormat(AL_FORMAT_MONO16)
+    , _alFreq(0)
 {
+    alGenBuffers(1, &_alBuffer);
+}
+
+bool Sound::Load()
+{
+    DuskBenchStart();
+
     FILE * file;
     OggVorbis_File vf;
     vorbis_info * vInfo;
@@ -15,23 +41,21 @@ Sound::Sound(const std::string& filename)
     int endian = 0;         // 0 = Little-Endian, 1 = Big-Endian
     int bitStream;
     long bytes;
-    std::vector<unsigned char> data;
 
-    alGenBuffers(1, &_alBuffer);
-
-    DuskLogInfo("Loading sound file '%s'", filename.c_str());
+    DuskLogInfo("Loading sound file '%s'", _filename.c_str());
 
-    file = fopen(filename.c_str(), "rb");
+    file = fopen(_filename.c_str(), "rb");
     if (!file)
     {
-        DuskLogError("Failed to load sound file '%s'", filename.c_str());
-        return;
+        DuskLogError("Failed to load sound file '%s'", _filename.c_str());
+        return false;
     }
 
     if (ov_open_callbacks(file, &vf, NULL, 0, OV_CALLBACKS_DEFAULT) < 0)
     {
         DuskLogError("Failed to open ogg callbacks");
-        return;
+        fclose(file);
+        return false;
     }
 
     vInfo = ov_info(&vf, -1);
@@ -49,13 +73,28 @@ Sound::Sound(const std::string& filename)
     do
     {
         bytes = ov_read(&vf, buffer, sizeof(buffer), endian, 2, 1, &bitStream);
-        data.insert(data.end(), buffer, buffer + bytes);
+        if (bytes > 0)
+        {
+            _data.insert(_data.end(), buffer, buffer + bytes);
+        }
     }
     while (bytes > 0);
 
-    alBufferData(_alBuffer, _alFormat, data.data(), static_cast<ALsizei>(data.size()), _alFreq);
-
     ov_clear(&vf);
+
+    DuskBenchEnd("Sound::Load()");
+    return true;
+}
+
+bool Sound::Upload()
+{
+    alBufferData(_alBuffer, _alFormat, _data.data(), static_cast<ALsizei>(_data.size()), _alFreq);
+
+    _data.clear();
+    _data.shrink_to_fit();
+
+    SetLoaded(true);
+    return true;
 }
 
 Sound::~Sound()
@@ -83,6 +122,12 @@ void AudioChannel::SetListenerPosition(glm::vec3 pos)
 
 void AudioChannel::Play(Sound * sound)
 {
+    if (!sound->IsLoaded())
+    {
+        DuskLogWarn("Sound is not loaded yet, skipping");
+        return;
+    }
+
     alSourcei(_alSource, AL_BUFFER, sound->GetALBuffer());
 
     alSourcePlay(_alSource);
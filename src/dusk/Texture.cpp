@@ -7,6 +7,8 @@
 
 namespace dusk {
 
+GLuint Texture::_GLPlaceholder = 0;
+
 std::shared_ptr<Texture> Texture::Create(const std::string& filename)
 {
     App * app = App::GetInst();
@@ -14,40 +16,93 @@ std::shared_ptr<Texture> Texture::Create(const std::string& filename)
     std::shared_ptr<Texture> ptr = app->GetTextureCache()->Get(id);
     if (!ptr)
     {
+        // OpenGL is weird
+        stbi_set_flip_vertically_on_load(true);
+
         ptr.reset(new Texture(filename));
         app->GetTextureCache()->Add(id, ptr);
+
+        ptr->_loading = true;
+        app->GetAssetLoader()->Queue(ptr);
+
+        Texture * texture = ptr.get();
+        texture->_watch = app->GetFileWatcher()->Watch(filename, [texture](const std::string&) {
+            texture->Reload();
+        });
     }
     return ptr;
 }
 
 Texture::Texture(const std::string& filename)
     : _filename(filename)
+    , _width(0)
+    , _height(0)
+    , _decodedWidth(0)
+    , _decodedHeight(0)
+    , _decodedPixels(nullptr)
     , _glID(0)
+    , _watch(FileWatcher::INVALID_WATCH)
+    , _loading(false)
 {
-    DuskLogInfo("Loading image '%s'", _filename.c_str());
+}
+
+Texture::~Texture()
+{
+    App::GetInst()->GetFileWatcher()->Unwatch(_watch);
+
+    Free();
+}
+
+void Texture::Reload()
+{
+    // The loader can't take the same asset twice at once
+    if (_loading.exchange(true))
+    {
+        return;
+    }
+
+    App::GetInst()->GetAssetLoader()->Queue(shared_from_this());
+}
+
+bool Texture::Load()
+{
+    DuskBenchStart();
 
-    // OpenGL is weird
-    stbi_set_flip_vertically_on_load(true);
+    DuskLogInfo("Loading image '%s'", _filename.c_str());
 
-    int width, height, comp;
-    unsigned char * image = stbi_load(_filename.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+    // Only the decoded image is touched here, Upload() takes it over on the
+    // main thread once the loader hands it back
+    int comp;
+    _decodedPixels = stbi_load(_filename.c_str(), &_decodedWidth, &_decodedHeight, &comp, STBI_rgb_alpha);
 
-    if (!image)
+    if (!_decodedPixels)
     {
         DuskLogError("Loading image failed '%s'", _filename.c_str());
-        goto error;
+        _loading = false;
+
+        DuskBenchEnd("Texture::Load()");
+        return false;
     }
 
-    glGenTextures(1, &_glID);
+    DuskBenchEnd("Texture::Load()");
+    return true;
+}
 
-    if (0 == _glID)
+bool Texture::Upload()
+{
+    // Reloads build a new texture and only replace the old one once it's
+    // complete, so a failure leaves the last good image in place
+    GLuint glID = 0;
+    glGenTextures(1, &glID);
+
+    if (0 == glID)
     {
         DuskLogError("Failed to create GL Texture");
         goto error;
     }
 
-    glBindTexture(GL_TEXTURE_2D, _glID);
-    DuskLogInfo("Binding image '%s' to ID %u", _filename.c_str(), _glID);
+    glBindTexture(GL_TEXTURE_2D, glID);
+    DuskLogInfo("Binding image '%s' to ID %u", _filename.c_str(), glID);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -55,34 +110,73 @@ Texture::Texture(const std::string& filename)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    // Clear anything left over, so the check below is about this upload
+    while (GL_NO_ERROR != glGetError());
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _decodedWidth, _decodedHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, _decodedPixels);
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    stbi_image_free(image);
-    image = nullptr;
+    if (GL_NO_ERROR != glGetError())
+    {
+        DuskLogError("Failed to upload image '%s'", _filename.c_str());
+        glDeleteTextures(1, &glID);
+        goto error;
+    }
 
     glBindTexture(GL_TEXTURE_2D, 0);
-    return;
-
-error:
 
-    stbi_image_free(image);
-    image = nullptr;
+    stbi_image_free(_decodedPixels);
+    _decodedPixels = nullptr;
 
     glDeleteTextures(1, &_glID);
-    _glID = 0;
+    _glID = glID;
+    _width = _decodedWidth;
+    _height = _decodedHeight;
+
+    SetLoaded(true);
+    _loading = false;
+    return true;
+
+error:
+
+    stbi_image_free(_decodedPixels);
+    _decodedPixels = nullptr;
 
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    _loading = false;
+    return false;
 }
 
-Texture::~Texture()
+void Texture::Free()
 {
+    stbi_image_free(_decodedPixels);
+    _decodedPixels = nullptr;
+
     glDeleteTextures(1, &_glID);
+    _glID = 0;
+
+    SetLoaded(false);
 }
 
 void Texture::Bind()
 {
-    glBindTexture(GL_TEXTURE_2D, _glID);
+    glBindTexture(GL_TEXTURE_2D, GetGLID());
+}
+
+GLuint Texture::GetPlaceholder()
+{
+    if (0 == _GLPlaceholder)
+    {
+        const unsigned char white[] = { 255, 255, 255, 255 };
+
+        glGenTextures(1, &_GLPlaceholder);
+        glBindTexture(GL_TEXTURE_2D, _GLPlaceholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    }
+    return _GLPlaceholder;
 }
 
 } // namespace dusk
@@ -0,0 +1,132 @@
+#include "dusk/ThreadPool.hpp"
+
+#include <dusk/Log.hpp>
+
+#include <algorithm>
+
+namespace dusk {
+
+ThreadPool::ThreadPool(unsigned int threadCount /*= 0*/)
+{
+    Start(threadCount);
+}
+
+ThreadPool::~ThreadPool()
+{
+    Stop();
+}
+
+unsigned int ThreadPool::GetDefaultThreadCount()
+{
+    unsigned int cores = std::thread::hardware_concurrency();
+
+    // Leave one core for the main thread
+    return (cores > 1 ? cores - 1 : 1);
+}
+
+unsigned int ThreadPool::GetDefaultLoaderThreadCount()
+{
+    return std::max(1u, GetDefaultThreadCount() / 4);
+}
+
+unsigned int ThreadPool::GetDefaultFrameThreadCount()
+{
+    return GetDefaultThreadCount() - GetDefaultLoaderThreadCount();
+}
+
+void ThreadPool::SetThreadCount(unsigned int threadCount)
+{
+    if (threadCount == GetThreadCount())
+    {
+        return;
+    }
+
+    Stop();
+    Start(threadCount);
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+    if (_workers.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push(std::move(job));
+    }
+    _jobReady.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobsDone.wait(lock, [this]() { return _jobs.empty() && 0 == _activeJobs; });
+}
+
+void ThreadPool::Start(unsigned int threadCount)
+{
+    _stopping = false;
+
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        _workers.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+
+    DuskLogInfo("Started thread pool with %u threads", threadCount);
+}
+
+void ThreadPool::Stop()
+{
+    if (_workers.empty())
+    {
+        return;
+    }
+
+    // Let the workers drain the queue before they exit
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _jobReady.notify_all();
+
+    for (std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+}
+
+void ThreadPool::WorkerMain()
+{
+    while (true)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobReady.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+
+            if (_jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(_jobs.front());
+            _jobs.pop();
+            ++_activeJobs;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_activeJobs;
+        }
+        _jobsDone.notify_all();
+    }
+}
+
+} // namespace dusk
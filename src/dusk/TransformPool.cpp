@@ -0,0 +1,534 @@
+#include "dusk/TransformPool.hpp"
+
+#include <dusk/Log.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+
+namespace dusk {
+
+const unsigned int TransformPool::INVALID_HANDLE;
+const unsigned int TransformPool::PARALLEL_THRESHOLD;
+
+TransformPool::TransformPool(ThreadPool * threadPool /*= nullptr*/)
+    : _alpha(1.0f)
+    , _hierarchyDirty(false)
+    , _pool(threadPool)
+{
+}
+
+TransformPool::~TransformPool()
+{
+}
+
+unsigned int TransformPool::Allocate(Order order /*= Order::TRS*/, void * owner /*= nullptr*/)
+{
+    unsigned int handle;
+    if (_freeHandles.empty())
+    {
+        handle = (unsigned int)_dense.size();
+        _dense.push_back(0);
+    }
+    else
+    {
+        handle = _freeHandles.back();
+        _freeHandles.pop_back();
+    }
+
+    _dense[handle] = (unsigned int)_handles.size();
+
+    _handles.push_back(handle);
+    _position.push_back(glm::vec3(0));
+    _rotation.push_back(glm::vec3(0));
+    _scale.push_back(glm::vec3(1));
+    _base.push_back(glm::mat4(1));
+    _local.push_back(glm::mat4(1));
+    _world.push_back(glm::mat4(1));
+    _previous.push_back(glm::mat4(1));
+    _render.push_back(glm::mat4(1));
+    _parent.push_back(INVALID_HANDLE);
+    _version.push_back(0);
+    _renderVersion.push_back(0);
+    _dirty.push_back(1);
+    _updated.push_back(0);
+    _order.push_back(order);
+    _owner.push_back(owner);
+
+    _hierarchyDirty = true;
+
+    return handle;
+}
+
+void TransformPool::Free(unsigned int handle)
+{
+    unsigned int index = _dense[handle];
+    unsigned int last = (unsigned int)_handles.size() - 1;
+
+    // Move the last slot into the hole to keep the arrays packed
+    if (index != last)
+    {
+        unsigned int moved = _handles[last];
+
+        _handles[index]  = moved;
+        _position[index] = _position[last];
+        _rotation[index] = _rotation[last];
+        _scale[index]    = _scale[last];
+        _base[index]     = _base[last];
+        _local[index]    = _local[last];
+        _world[index]    = _world[last];
+        _previous[index] = _previous[last];
+        _render[index]   = _render[last];
+        _parent[index]   = _parent[last];
+        _version[index]  = _version[last];
+        _renderVersion[index] = _renderVersion[last];
+        _dirty[index]    = _dirty[last];
+        _updated[index]  = _updated[last];
+        _order[index]    = _order[last];
+        _owner[index]    = _owner[last];
+
+        _dense[moved] = index;
+    }
+
+    _handles.pop_back();
+    _position.pop_back();
+    _rotation.pop_back();
+    _scale.pop_back();
+    _base.pop_back();
+    _local.pop_back();
+    _world.pop_back();
+    _previous.pop_back();
+    _render.pop_back();
+    _parent.pop_back();
+    _version.pop_back();
+    _renderVersion.pop_back();
+    _dirty.pop_back();
+    _updated.pop_back();
+    _order.pop_back();
+    _owner.pop_back();
+
+    _dense[handle] = INVALID_HANDLE;
+    _freeHandles.push_back(handle);
+
+    // The slot moved into the hole may now sit before its parent
+    _hierarchyDirty = true;
+}
+
+void TransformPool::SetPosition(unsigned int handle, const glm::vec3& pos)
+{
+    _position[_dense[handle]] = pos;
+    MarkDirty(handle);
+}
+
+void TransformPool::SetRotation(unsigned int handle, const glm::vec3& rot)
+{
+    _rotation[_dense[handle]] = rot;
+    MarkDirty(handle);
+}
+
+void TransformPool::SetScale(unsigned int handle, const glm::vec3& scale)
+{
+    _scale[_dense[handle]] = scale;
+    MarkDirty(handle);
+}
+
+void TransformPool::SetPositions(const unsigned int * handles, size_t count, const float * values)
+{
+    SetMany(_position, handles, count, values);
+}
+
+void TransformPool::GetPositions(const unsigned int * handles, size_t count, float * values) const
+{
+    GetMany(_position, handles, count, values);
+}
+
+void TransformPool::SetRotations(const unsigned int * handles, size_t count, const float * values)
+{
+    SetMany(_rotation, handles, count, values);
+}
+
+void TransformPool::GetRotations(const unsigned int * handles, size_t count, float * values) const
+{
+    GetMany(_rotation, handles, count, values);
+}
+
+void TransformPool::SetScales(const unsigned int * handles, size_t count, const float * values)
+{
+    SetMany(_scale, handles, count, values);
+}
+
+void TransformPool::GetScales(const unsigned int * handles, size_t count, float * values) const
+{
+    GetMany(_scale, handles, count, values);
+}
+
+void TransformPool::SetMany(std::vector<glm::vec3>& data, const unsigned int * handles, size_t count, const float * values)
+{
+    for (size_t i = 0; i < count; ++i, values += 3)
+    {
+        unsigned int index = _dense[handles[i]];
+        data[index] = glm::vec3(values[0], values[1], values[2]);
+        _dirty[index] = 1;
+    }
+}
+
+void TransformPool::GetMany(const std::vector<glm::vec3>& data, const unsigned int * handles, size_t count, float * values) const
+{
+    for (size_t i = 0; i < count; ++i, values += 3)
+    {
+        const glm::vec3& value = data[_dense[handles[i]]];
+        values[0] = value.x;
+        values[1] = value.y;
+        values[2] = value.z;
+    }
+}
+
+void TransformPool::SetBase(unsigned int handle, const glm::mat4& base)
+{
+    _base[_dense[handle]] = base;
+    MarkDirty(handle);
+}
+
+bool TransformPool::SetParent(unsigned int handle, unsigned int parent)
+{
+    for (unsigned int it = parent; INVALID_HANDLE != it; it = _parent[_dense[it]])
+    {
+        if (it == handle)
+        {
+            DuskLogError("Refusing to parent transform %u to its own descendant %u", handle, parent);
+            return false;
+        }
+    }
+
+    _parent[_dense[handle]] = parent;
+    MarkDirty(handle);
+
+    _hierarchyDirty = true;
+
+    return true;
+}
+
+template <typename T>
+void TransformPool::Permute(std::vector<T>& data)
+{
+    std::vector<T> sorted;
+    sorted.reserve(data.size());
+
+    for (unsigned int index : _sortOrder)
+    {
+        sorted.push_back(data[index]);
+    }
+
+    data.swap(sorted);
+}
+
+template <typename Func>
+void TransformPool::ParallelFor(unsigned int begin, unsigned int end, Func func)
+{
+    unsigned int threads = (_pool ? _pool->GetThreadCount() : 0);
+
+    if (0 == threads || end - begin < PARALLEL_THRESHOLD)
+    {
+        func(begin, end);
+        return;
+    }
+
+    // The calling thread takes the first chunk itself
+    unsigned int chunk = (end - begin + threads) / (threads + 1);
+
+    for (unsigned int start = begin + chunk; start < end; start += chunk)
+    {
+        unsigned int stop = std::min(start + chunk, end);
+        _pool->Submit([func, start, stop]() {
+            func(start, stop);
+        });
+    }
+
+    func(begin, begin + chunk);
+
+    _pool->Wait();
+}
+
+void TransformPool::Update()
+{
+    unsigned int count = (unsigned int)_handles.size();
+
+    // Whatever stops moving now must not be left part way through a blend
+    if (_alpha < 1.0f)
+    {
+        for (unsigned int handle : _changed)
+        {
+            unsigned int index = _dense[handle];
+            if (INVALID_HANDLE != index)
+            {
+                _render[index] = _world[index];
+                ++_renderVersion[index];
+            }
+        }
+    }
+
+    _changed.clear();
+
+    if (_hierarchyDirty)
+    {
+        SortHierarchy();
+        _hierarchyDirty = false;
+    }
+
+    std::fill(_updated.begin(), _updated.end(), 0);
+
+    ParallelFor(0, count, [this](unsigned int begin, unsigned int end) {
+        UpdateLocals(begin, end);
+    });
+
+    // Each level only reads the world matrices of the level above it
+    for (size_t level = 0; level + 1 < _levels.size(); ++level)
+    {
+        ParallelFor(_levels[level], _levels[level + 1], [this](unsigned int begin, unsigned int end) {
+            UpdateWorlds(begin, end);
+        });
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (_updated[i])
+        {
+            _changed.push_back(_handles[i]);
+
+            _render[i] = _world[i];
+            ++_renderVersion[i];
+        }
+    }
+
+    _alpha = 1.0f;
+
+    std::fill(_dirty.begin(), _dirty.end(), 0);
+}
+
+// Matrices are split into translation, rotation and scale, which blend
+// without the shearing a straight lerp would give
+static glm::mat4 BlendWorld(const glm::mat4& from, const glm::mat4& to, float alpha)
+{
+    glm::mat3 axes[2] = { glm::mat3(from), glm::mat3(to) };
+    glm::vec3 scale[2];
+
+    for (int m = 0; m < 2; ++m)
+    {
+        scale[m] = glm::vec3(glm::length(axes[m][0]), glm::length(axes[m][1]), glm::length(axes[m][2]));
+
+        if (scale[m].x < 1e-6f || scale[m].y < 1e-6f || scale[m].z < 1e-6f)
+        {
+            return from + (to - from) * alpha;
+        }
+
+        // Mirrored, keep the rotation proper
+        if (glm::determinant(axes[m]) < 0.0f)
+        {
+            scale[m].x = -scale[m].x;
+        }
+
+        axes[m][0] /= scale[m].x;
+        axes[m][1] /= scale[m].y;
+        axes[m][2] /= scale[m].z;
+    }
+
+    glm::mat3 rotation = glm::mat3_cast(glm::slerp(glm::quat_cast(axes[0]), glm::quat_cast(axes[1]), alpha));
+    glm::vec3 s = glm::mix(scale[0], scale[1], alpha);
+    glm::vec3 t = glm::mix(glm::vec3(from[3]), glm::vec3(to[3]), alpha);
+
+    return glm::mat4(
+        glm::vec4(rotation[0] * s.x, 0.0f),
+        glm::vec4(rotation[1] * s.y, 0.0f),
+        glm::vec4(rotation[2] * s.z, 0.0f),
+        glm::vec4(t, 1.0f));
+}
+
+void TransformPool::Interpolate(float alpha)
+{
+    alpha = glm::clamp(alpha, 0.0f, 1.0f);
+    if (alpha == _alpha)
+    {
+        return;
+    }
+
+    _alpha = alpha;
+
+    ParallelFor(0, (unsigned int)_changed.size(), [this, alpha](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            // Freed since the last update
+            unsigned int index = _dense[_changed[i]];
+            if (INVALID_HANDLE == index)
+            {
+                continue;
+            }
+
+            _render[index] = (alpha < 1.0f ? BlendWorld(_previous[index], _world[index], alpha) : _world[index]);
+            ++_renderVersion[index];
+        }
+    });
+}
+
+void TransformPool::SortHierarchy()
+{
+    unsigned int count = (unsigned int)_handles.size();
+
+    _depth.assign(count, INVALID_HANDLE);
+
+    unsigned int maxDepth = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        // Walk up until we reach a root or a slot we've already measured,
+        // which after the first sort is almost always the direct parent
+        unsigned int depth = 0;
+        unsigned int index = i;
+        while (INVALID_HANDLE != _parent[index])
+        {
+            index = _dense[_parent[index]];
+            ++depth;
+
+            if (INVALID_HANDLE != _depth[index])
+            {
+                depth += _depth[index];
+                break;
+            }
+        }
+
+        _depth[i] = depth;
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    // Counting sort by depth, stable so siblings keep their relative order
+    _levels.assign(maxDepth + 2, 0);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        ++_levels[_depth[i] + 1];
+    }
+
+    for (unsigned int level = 1; level < _levels.size(); ++level)
+    {
+        _levels[level] += _levels[level - 1];
+    }
+
+    _sortOrder.resize(count);
+
+    std::vector<unsigned int> next(_levels.begin(), _levels.end() - 1);
+    bool sorted = true;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int pos = next[_depth[i]]++;
+        _sortOrder[pos] = i;
+        sorted &= (pos == i);
+    }
+
+    if (sorted)
+    {
+        return;
+    }
+
+    Permute(_handles);
+    Permute(_position);
+    Permute(_rotation);
+    Permute(_scale);
+    Permute(_base);
+    Permute(_local);
+    Permute(_world);
+    Permute(_previous);
+    Permute(_render);
+    Permute(_parent);
+    Permute(_version);
+    Permute(_renderVersion);
+    Permute(_dirty);
+    Permute(_updated);
+    Permute(_order);
+    Permute(_owner);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        _dense[_handles[i]] = i;
+    }
+}
+
+void TransformPool::UpdateLocals(unsigned int begin, unsigned int end)
+{
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        if (!_dirty[i])
+        {
+            continue;
+        }
+
+        const glm::vec3& t = _position[i];
+        const glm::vec3& s = _scale[i];
+
+        float sx = std::sin(_rotation[i].x), cx = std::cos(_rotation[i].x);
+        float sy = std::sin(_rotation[i].y), cy = std::cos(_rotation[i].y);
+        float sz = std::sin(_rotation[i].z), cz = std::cos(_rotation[i].z);
+
+        // Rx * Ry * Rz, row major
+        float r[3][3] = {
+            { cy * cz,                  -cy * sz,                  sy      },
+            { sx * sy * cz + cx * sz,   -sx * sy * sz + cx * cz,   -sx * cy },
+            { -cx * sy * cz + sx * sz,  cx * sy * sz + sx * cz,    cx * cy },
+        };
+
+        glm::mat4& m = _local[i];
+
+        if (Order::TRS == _order[i])
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                m[c] = glm::vec4(r[0][c] * s[c], r[1][c] * s[c], r[2][c] * s[c], 0.0f);
+            }
+            m[3] = glm::vec4(t, 1.0f);
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                m[c] = glm::vec4(r[0][c] * s.x, r[1][c] * s.y, r[2][c] * s.z, 0.0f);
+            }
+            m[3] = glm::vec4(
+                s.x * (r[0][0] * t.x + r[0][1] * t.y + r[0][2] * t.z),
+                s.y * (r[1][0] * t.x + r[1][1] * t.y + r[1][2] * t.z),
+                s.z * (r[2][0] * t.x + r[2][1] * t.y + r[2][2] * t.z),
+                1.0f);
+        }
+    }
+}
+
+void TransformPool::UpdateWorlds(unsigned int begin, unsigned int end)
+{
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        unsigned int parent = _parent[i];
+        glm::mat4 world;
+
+        if (INVALID_HANDLE == parent)
+        {
+            if (!_dirty[i])
+            {
+                continue;
+            }
+
+            world = _base[i] * _local[i];
+        }
+        else
+        {
+            unsigned int parentIndex = _dense[parent];
+            if (!_dirty[i] && !_updated[parentIndex])
+            {
+                continue;
+            }
+
+            world = _world[parentIndex] * _base[i] * _local[i];
+        }
+
+        // New slots appear in place rather than sliding in from the origin
+        _previous[i] = (_version[i] ? _world[i] : world);
+        _world[i] = world;
+
+        ++_version[i];
+        _updated[i] = 1;
+    }
+}
+
+} // namespace dusk
@@ -1,19 +1,48 @@
 #include "dusk/UI.hpp"
 
 #include <dusk/App.hpp>
+#include <dusk/ScriptProfiler.hpp>
 
 namespace dusk {
 
 bool UI::ConsoleShown = false;
+bool UI::RenderStatsShown = false;
+bool UI::ProfilerShown = false;
+std::mutex UI::_logMutex;
 std::vector<UI::LogItem> UI::_logItems;
 
+static void RenderProfileEntries(const char * id, const std::vector<ScriptProfiler::Entry>& entries, bool showSelf)
+{
+    static const size_t MAX_ROWS = 20;
+
+    ImGui::Columns(4, id);
+    ImGui::Text("Name"); ImGui::NextColumn();
+    ImGui::Text(showSelf ? "Samples" : "Calls"); ImGui::NextColumn();
+    ImGui::Text("Total ms"); ImGui::NextColumn();
+    ImGui::Text(showSelf ? "Self ms" : "Max ms"); ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (size_t i = 0; i < entries.size() && i < MAX_ROWS; ++i)
+    {
+        const ScriptProfiler::Entry& entry = entries[i];
+
+        ImGui::Text("%s", entry.name.c_str()); ImGui::NextColumn();
+        ImGui::Text("%u", entry.calls); ImGui::NextColumn();
+        ImGui::Text("%.3f", entry.total); ImGui::NextColumn();
+        ImGui::Text("%.3f", (showSelf ? entry.self : entry.max)); ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+}
+
 void UI::Render()
 {
     if (ImGui::BeginMainMenuBar())
     {
         // TODO: Decouple from App
         ImGui::SameLine((float)App::GetInst()->WindowWidth - 150, 0.0f);
-        ImGui::Text("%.2f FPS (%.2f ms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+        FramePacer * pacer = App::GetInst()->GetFramePacer();
+        ImGui::Text("%.2f FPS (%.2f ms)", pacer->GetCurrentFPS(), pacer->GetFrameTime());
         ImGui::EndMainMenuBar();
     }
 
@@ -62,12 +91,15 @@ void UI::Render()
             ImGui::Separator();
 
             ImGui::BeginChild("Scroll", ImVec2(0, -ImGui::GetItemsLineHeightWithSpacing()), false, ImGuiWindowFlags_HorizontalScrollbar);
-            for (const LogItem& item : _logItems)
             {
-                if (!filter.PassFilter(item.message.c_str()))
-                    continue;
-
-                ImGui::TextColored(item.color, "%s", item.message.c_str());
+                std::lock_guard<std::mutex> lock(_logMutex);
+                for (const LogItem& item : _logItems)
+                {
+                    if (!filter.PassFilter(item.message.c_str()))
+                        continue;
+
+                    ImGui::TextColored(item.color, "%s", item.message.c_str());
+                }
             }
             ImGui::SetScrollHere();
             ImGui::EndChild();
@@ -77,11 +109,112 @@ void UI::Render()
         ImGui::End();
     }
 
+    if (RenderStatsShown)
+    {
+        Scene * scene = App::GetInst()->GetScene();
+
+        ImGui::SetNextWindowSize(ImVec2(250, 500), ImGuiSetCond_FirstUseEver);
+        if (ImGui::Begin("Render Stats", &UI::RenderStatsShown) && scene)
+        {
+            const RenderStats& stats = scene->GetRenderQueue()->GetStats();
+
+            FramePacer * pacer = App::GetInst()->GetFramePacer();
+
+            ImGui::Text("Frame Time:        %.2f ms", pacer->GetFrameTime());
+            ImGui::Text("Wait Time:         %.2f ms", pacer->GetWaitTime());
+            ImGui::Text("Dropped Updates:   %.1f ms", App::GetInst()->GetDroppedUpdateTime());
+            ImGui::Text("Overrun Frames:    %u", App::GetInst()->GetDroppedUpdateFrames());
+            ImGui::Separator();
+            ImGui::Text("Visible Actors:    %u", scene->GetVisibleCount());
+            ImGui::Text("Culled Actors:     %u", scene->GetCulledCount());
+            ImGui::Separator();
+            ImGui::Text("Draw Items:        %u", stats.items);
+            ImGui::Text("Draw Calls:        %u", stats.drawCalls);
+            ImGui::Text("Instanced Calls:   %u", stats.instancedDrawCalls);
+            ImGui::Separator();
+            ImGui::Text("Shader Binds:      %u", stats.shaderBinds);
+            ImGui::Text("Material Binds:    %u", stats.materialBinds);
+            ImGui::Text("Texture Binds:     %u", stats.textureBinds);
+            ImGui::Text("VAO Binds:         %u", stats.vaoBinds);
+            ImGui::Text("Transform Binds:   %u", stats.transformBinds);
+            ImGui::Text("Uniform Data:      %.1f KB", stats.uniformBytes / 1024.0f);
+            ImGui::Separator();
+            ImGui::Text("Skipped Binds:     %u", stats.skippedBinds);
+
+            EventBus * bus = App::GetInst()->GetEventBus();
+            AssetLoader * loader = App::GetInst()->GetAssetLoader();
+
+            ImGui::Separator();
+            ImGui::Text("Event Bus Depth:   %zu / %zu", bus->GetDepth(), bus->GetCapacity());
+            ImGui::Text("Event Bus Peak:    %zu", bus->GetHighWater());
+            ImGui::Text("Event Bus Stalls:  %zu", bus->GetStallCount());
+            ImGui::Text("Event Bus Dropped: %zu", bus->GetDroppedCount());
+            ImGui::Text("Pending Uploads:   %zu", loader->GetCompletedDepth());
+
+            ImGui::Separator();
+            ImGui::Text("Lua Memory:        %.1f KB", ScriptHost::GetTotalMemory() / 1024.0f);
+            ImGui::Text("Lua GC Time:       %.3f / %.1f ms", ScriptHost::GetGCTime(), ScriptHost::GetGCBudget());
+            ImGui::Text("Lua GC Cycles:     %u", ScriptHost::GetGCCycleCount());
+        }
+        ImGui::End();
+    }
+
+    if (ProfilerShown)
+    {
+        ScriptProfiler& profiler = ScriptHost::GetProfiler();
+
+        ImGui::SetNextWindowSize(ImVec2(600, 500), ImGuiSetCond_FirstUseEver);
+        if (ImGui::Begin("Lua Profiler", &UI::ProfilerShown))
+        {
+            if (ImGui::SmallButton(profiler.IsRunning() ? "Stop" : "Start"))
+            {
+                if (profiler.IsRunning())
+                    profiler.Stop();
+                else
+                    profiler.Start();
+            }
+            ImGui::SameLine();
+
+            if (ImGui::SmallButton("Reset"))
+            {
+                profiler.Reset();
+            }
+            ImGui::SameLine();
+
+            if (ImGui::SmallButton("Export"))
+            {
+                profiler.ExportFolded("lua-profile.folded");
+            }
+            ImGui::SameLine();
+
+            ImGui::Text("%u samples", profiler.GetSampleCount());
+
+            ImGui::Separator();
+
+            if (ImGui::CollapsingHeader("Callbacks", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                RenderProfileEntries("Callbacks", profiler.GetCalls(), false);
+            }
+
+            if (ImGui::CollapsingHeader("Functions", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                RenderProfileEntries("Functions", profiler.GetFunctions(), true);
+            }
+
+            if (ImGui::CollapsingHeader("Lines"))
+            {
+                RenderProfileEntries("Lines", profiler.GetLines(), true);
+            }
+        }
+        ImGui::End();
+    }
+
     ImGui::Render();
 }
 
 void UI::Log(ImVec4 color, const char * message)
 {
+    std::lock_guard<std::mutex> lock(_logMutex);
     _logItems.push_back({ color, std::string(message) });
 }
 
@@ -0,0 +1,144 @@
+#include "dusk/UniformRing.hpp"
+
+#include <dusk/Log.hpp>
+#include <algorithm>
+
+namespace dusk {
+
+UniformRing::UniformRing(unsigned int frameCount /*= 3*/)
+    : _frameCount(frameCount)
+    , _frameIndex(0)
+    , _alignment(256)
+    , _frameSize(0)
+    , _writeOffset(0)
+    , _glUBO(0)
+    , _mapped(nullptr)
+    , _fences(frameCount, nullptr)
+{
+}
+
+UniformRing::~UniformRing()
+{
+    for (GLsync& fence : _fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+        }
+    }
+
+    glDeleteBuffers(1, &_glUBO);
+}
+
+bool UniformRing::BeginFrame(size_t size)
+{
+    if (0 == _glUBO)
+    {
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment > 0)
+        {
+            _alignment = (size_t)alignment;
+        }
+
+        glGenBuffers(1, &_glUBO);
+    }
+
+    if (size > _frameSize)
+    {
+        Resize(std::max(size, _frameSize * 2));
+    }
+
+    _frameIndex = (_frameIndex + 1) % _frameCount;
+    _writeOffset = 0;
+
+    // Only blocks if the GPU is still reading this region from frameCount frames ago
+    GLsync& fence = _fences[_frameIndex];
+    if (fence)
+    {
+        GLenum result;
+        do
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        while (GL_TIMEOUT_EXPIRED == result);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, _glUBO);
+    _mapped = (GLbyte *)glMapBufferRange(GL_UNIFORM_BUFFER, _frameIndex * _frameSize, _frameSize,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    if (!_mapped)
+    {
+        DuskLogError("Failed to map uniform ring region %u", _frameIndex);
+        return false;
+    }
+
+    return true;
+}
+
+GLintptr UniformRing::Write(const void * data, size_t size)
+{
+    if (!_mapped || _writeOffset + size > _frameSize)
+    {
+        DuskLogError("Uniform ring overflow, %zu bytes requested", size);
+        return -1;
+    }
+
+    GLintptr offset = (GLintptr)_writeOffset;
+    memcpy(_mapped + offset, data, size);
+    _writeOffset += Align(size);
+
+    return (GLintptr)(_frameIndex * _frameSize) + offset;
+}
+
+void UniformRing::EndWrite()
+{
+    if (!_mapped)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, _glUBO);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    _mapped = nullptr;
+}
+
+void UniformRing::EndFrame()
+{
+    _fences[_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void UniformRing::BindRange(GLuint index, GLintptr offset, size_t size)
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER, index, _glUBO, offset, size);
+}
+
+void UniformRing::Resize(size_t frameSize)
+{
+    // Orphaning the old storage is safe, the driver keeps it alive for pending draws
+    for (GLsync& fence : _fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    _frameSize = Align(frameSize);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, _glUBO);
+    glBufferData(GL_UNIFORM_BUFFER, _frameSize * _frameCount, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    DuskLogInfo("Resized uniform ring to %zu bytes per frame", _frameSize);
+}
+
+} // namespace dusk
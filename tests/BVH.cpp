@@ -0,0 +1,192 @@
+// Checks BVH queries against a brute force walk of the same boxes, results
+// must be exact even though the tree stores fattened bounds.
+
+#include "Test.hpp"
+
+#include <dusk/BVH.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace dusk;
+
+static float Random(float range)
+{
+    return (float)rand() / (float)RAND_MAX * range;
+}
+
+static AABB MakeBox(const glm::vec3& center, float halfSize)
+{
+    AABB box;
+    box.min = center - glm::vec3(halfSize);
+    box.max = center + glm::vec3(halfSize);
+    return box;
+}
+
+static bool InRadius(const AABB& box, const glm::vec3& center, float radius)
+{
+    glm::vec3 closest = glm::min(glm::max(center, box.min), box.max);
+    glm::vec3 offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+static void TestQueryRadius()
+{
+    const int count = 1000;
+
+    BVH bvh;
+    std::vector<AABB> boxes(count);
+    std::vector<int> proxies(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        boxes[i] = MakeBox(glm::vec3(Random(100.0f), Random(100.0f), Random(100.0f)), 0.5f);
+        proxies[i] = bvh.Insert(boxes[i], &boxes[i]);
+    }
+
+    // Small moves stay inside the fat bounds, large ones reinsert
+    for (int i = 0; i < count; ++i)
+    {
+        float step = (i % 2 ? 0.05f : 20.0f);
+        boxes[i] = MakeBox(boxes[i].GetCenter() + glm::vec3(step, 0.0f, 0.0f), 0.5f);
+        bvh.Move(proxies[i], boxes[i]);
+        DuskCheck(bvh.GetBounds(proxies[i]).min == boxes[i].min);
+    }
+
+    for (int i = 0; i < count; i += 4)
+    {
+        bvh.Remove(proxies[i]);
+        proxies[i] = BVH::NULL_NODE;
+    }
+
+    DuskCheck(bvh.GetLeafCount() == (size_t)(count - count / 4));
+
+    for (int q = 0; q < 100; ++q)
+    {
+        glm::vec3 center(Random(120.0f), Random(100.0f), Random(100.0f));
+        float radius = 1.0f + Random(8.0f);
+
+        std::vector<void *> results;
+        bvh.QueryRadius(center, radius, results);
+
+        std::vector<void *> expected;
+        for (int i = 0; i < count; ++i)
+        {
+            if (BVH::NULL_NODE != proxies[i] && InRadius(boxes[i], center, radius))
+            {
+                expected.push_back(&boxes[i]);
+            }
+        }
+
+        std::sort(results.begin(), results.end());
+        std::sort(expected.begin(), expected.end());
+        DuskCheck(results == expected);
+    }
+}
+
+static void TestRaycast()
+{
+    BVH bvh;
+    AABB near = MakeBox(glm::vec3(10.0f, 0.0f, 0.0f), 1.0f);
+    AABB far = MakeBox(glm::vec3(20.0f, 0.0f, 0.0f), 1.0f);
+    AABB side = MakeBox(glm::vec3(5.0f, 1.2f, 0.0f), 1.0f);
+
+    bvh.Insert(near, &near);
+    bvh.Insert(far, &far);
+    int sideProxy = bvh.Insert(side, &side);
+
+    float dist = -1.0f;
+    void * hit = bvh.Raycast(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 100.0f, &dist);
+    DuskCheck(hit == &near);
+    DuskCheck(std::fabs(dist - 9.0f) < 1e-4f);
+
+    // Passes through the fat bounds of side, but not the box itself
+    hit = bvh.Raycast(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 8.5f, &dist);
+    DuskCheck(nullptr == hit);
+
+    // Once side covers the ray it is nearest
+    side = MakeBox(glm::vec3(5.0f, 0.9f, 0.0f), 1.0f);
+    bvh.Move(sideProxy, side);
+    hit = bvh.Raycast(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 100.0f, &dist);
+    DuskCheck(hit == &side);
+    DuskCheck(std::fabs(dist - 4.0f) < 1e-4f);
+
+    hit = bvh.Raycast(glm::vec3(0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), 100.0f, &dist);
+    DuskCheck(nullptr == hit);
+}
+
+static void TestConcurrentQueries()
+{
+    const int count = 1000;
+    const int queryCount = 200;
+    const int threadCount = 4;
+
+    BVH bvh;
+    std::vector<AABB> boxes(count);
+    for (int i = 0; i < count; ++i)
+    {
+        boxes[i] = MakeBox(glm::vec3(Random(100.0f), Random(100.0f), Random(100.0f)), 0.5f);
+        bvh.Insert(boxes[i], &boxes[i]);
+    }
+
+    std::vector<glm::vec3> centers(queryCount);
+    std::vector<std::vector<void *>> expected(queryCount);
+    std::vector<void *> expectedHits(queryCount);
+    for (int q = 0; q < queryCount; ++q)
+    {
+        centers[q] = glm::vec3(Random(100.0f), Random(100.0f), Random(100.0f));
+        bvh.QueryRadius(centers[q], 10.0f, expected[q]);
+        std::sort(expected[q].begin(), expected[q].end());
+        expectedHits[q] = bvh.Raycast(centers[q], glm::vec3(0.0f, 0.0f, 1.0f), 100.0f);
+    }
+
+    // Each thread must walk the tree with its own stack
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&]() {
+            std::vector<void *> results;
+            for (int pass = 0; pass < 20; ++pass)
+            {
+                for (int q = 0; q < queryCount; ++q)
+                {
+                    results.clear();
+                    bvh.QueryRadius(centers[q], 10.0f, results);
+                    std::sort(results.begin(), results.end());
+                    if (results != expected[q])
+                    {
+                        ++mismatches;
+                    }
+
+                    if (bvh.Raycast(centers[q], glm::vec3(0.0f, 0.0f, 1.0f), 100.0f) != expectedHits[q])
+                    {
+                        ++mismatches;
+                    }
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    DuskCheck(0 == mismatches);
+}
+
+int main(int argc, char ** argv)
+{
+    srand(1);
+
+    TestQueryRadius();
+    TestRaycast();
+    TestConcurrentQueries();
+
+    return DuskTestResult();
+}
@@ -0,0 +1,198 @@
+// Checks MPSCQueue capacity, ordering and back-pressure, and that EventBus
+// delivers every event from many producer threads in per-producer order.
+
+#include "Test.hpp"
+
+#include <dusk/EventBus.hpp>
+#include <dusk/EventDispatcher.hpp>
+#include <dusk/MPSCQueue.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace dusk;
+
+static const EventID TEST_EVENT = 1;
+
+static const int PRODUCERS = 4;
+static const int PER_PRODUCER = 20000;
+
+class ProducerEventData : public EventData
+{
+public:
+
+    ProducerEventData(int producer, int sequence)
+        : producer(producer)
+        , sequence(sequence)
+    { }
+
+    int producer;
+    int sequence;
+
+}; // class ProducerEventData
+
+struct Tracked : public EventData
+{
+    static std::atomic<int> Live;
+
+    Tracked() { ++Live; }
+    Tracked(const Tracked&) : EventData() { ++Live; }
+    ~Tracked() { --Live; }
+};
+
+std::atomic<int> Tracked::Live { 0 };
+
+class Receiver : public IEventDispatcher
+{
+public:
+
+    Receiver()
+        : next(PRODUCERS, 0)
+    {
+        AddEventListener(TEST_EVENT, this, &Receiver::OnEvent);
+    }
+
+    void OnEvent(const Event& event)
+    {
+        ++received;
+
+        const ProducerEventData * data = event.GetDataAs<ProducerEventData>();
+        if (!data)
+        {
+            return;
+        }
+
+        if (data->sequence != next[data->producer])
+        {
+            ++outOfOrder;
+        }
+        next[data->producer] = data->sequence + 1;
+    }
+
+    std::vector<int> next;
+    int received = 0;
+    int outOfOrder = 0;
+
+}; // class Receiver
+
+static void TestQueue()
+{
+    MPSCQueue<int> queue(5);
+    DuskCheck(queue.GetCapacity() == 8);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        DuskCheck(queue.TryPush([i](int& value) { value = i; }));
+    }
+
+    DuskCheck(!queue.TryPush([](int& value) { value = -1; }));
+    DuskCheck(queue.GetRejectedCount() == 1);
+    DuskCheck(queue.GetSize() == 8);
+    DuskCheck(queue.GetHighWater() == 8);
+
+    int expected = 0;
+    bool ordered = true;
+    while (queue.TryPop([&](int& value) { ordered &= (value == expected++); }))
+    { }
+
+    DuskCheck(ordered && 8 == expected);
+    DuskCheck(queue.GetSize() == 0);
+
+    // Wraps around the ring, and a blocked producer resumes once we pop
+    std::atomic<bool> pushed { false };
+    for (int i = 0; i < 8; ++i)
+    {
+        queue.Push([i](int& value) { value = i; });
+    }
+
+    std::thread producer([&]() {
+        queue.Push([](int& value) { value = 8; });
+        pushed = true;
+    });
+
+    while (0 == queue.GetStallCount())
+    {
+        std::this_thread::yield();
+    }
+    DuskCheck(!pushed);
+
+    expected = 0;
+    ordered = true;
+    while (expected < 9)
+    {
+        queue.TryPop([&](int& value) { ordered &= (value == expected++); });
+    }
+
+    producer.join();
+    DuskCheck(pushed && ordered);
+}
+
+static void TestBus()
+{
+    Receiver receiver;
+    EventBus bus(256);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&bus, &receiver, p]() {
+            for (int i = 0; i < PER_PRODUCER; ++i)
+            {
+                bus.Post(&receiver, TEST_EVENT, ProducerEventData(p, i));
+            }
+        });
+    }
+
+    // The bus is far smaller than what is posted, so producers have to wait
+    while (receiver.received < PRODUCERS * PER_PRODUCER)
+    {
+        if (0 == bus.Dispatch(64))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    DuskCheck(receiver.received == PRODUCERS * PER_PRODUCER);
+    DuskCheck(receiver.outOfOrder == 0);
+    DuskCheck(bus.GetDepth() == 0);
+    DuskCheck(bus.GetStallCount() > 0);
+}
+
+static void TestMainThread()
+{
+    Receiver receiver;
+
+    {
+        EventBus bus(4);
+
+        // Posting from the consumer thread drops rather than blocking forever
+        for (int i = 0; i < 6; ++i)
+        {
+            bus.Post(&receiver, TEST_EVENT, Tracked());
+        }
+        DuskCheck(bus.GetDroppedCount() == 2);
+        DuskCheck(Tracked::Live == 4);
+
+        DuskCheck(bus.Dispatch(1) == 1);
+        DuskCheck(Tracked::Live == 3);
+        DuskCheck(receiver.received == 1);
+    }
+
+    // Undelivered payloads are destroyed with the bus
+    DuskCheck(Tracked::Live == 0);
+}
+
+int main(int argc, char ** argv)
+{
+    TestQueue();
+    TestBus();
+    TestMainThread();
+
+    return DuskTestResult();
+}
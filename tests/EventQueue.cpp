@@ -0,0 +1,187 @@
+// Checks FrameArena allocation and cleanup, and EventQueue ordering,
+// deferral, coalescing and cancellation.
+
+#include "Test.hpp"
+
+#include <dusk/EventDispatcher.hpp>
+#include <dusk/EventQueue.hpp>
+#include <dusk/FrameArena.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace dusk;
+
+static const EventID TEST_EVENT = 1;
+static const EventID OTHER_EVENT = 2;
+
+class ValueEventData : public EventData
+{
+public:
+
+    ValueEventData(int value) : value(value) { }
+
+    int value;
+
+}; // class ValueEventData
+
+struct Counted
+{
+    static int Live;
+
+    Counted() { ++Live; }
+    ~Counted() { --Live; }
+};
+
+int Counted::Live = 0;
+
+class Recorder : public IEventDispatcher
+{
+public:
+
+    Recorder()
+    {
+        AddEventListener(TEST_EVENT, this, &Recorder::OnEvent);
+        AddEventListener(OTHER_EVENT, this, &Recorder::OnEvent);
+    }
+
+    void OnEvent(const Event& event)
+    {
+        const ValueEventData * data = event.GetDataAs<ValueEventData>();
+        received.push_back(data ? data->value : -1);
+
+        if (data && repost && EventQueue::GetInst())
+        {
+            repost = false;
+            EventQueue::GetInst()->Post(this, TEST_EVENT, ValueEventData(data->value + 100));
+        }
+    }
+
+    std::vector<int> received;
+    bool repost = false;
+
+}; // class Recorder
+
+static void TestFrameArena()
+{
+    FrameArena arena(256);
+
+    void * small = arena.Allocate(3, 1);
+    void * aligned = arena.Allocate(8, 64);
+    DuskCheck(small != nullptr);
+    DuskCheck(0 == ((uintptr_t)aligned % 64));
+
+    // Bigger than a block gets a block of its own
+    unsigned char * large = (unsigned char *)arena.Allocate(1024);
+    large[1023] = 1;
+    DuskCheck(arena.GetCapacity() >= 1024 + 256);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        arena.New<Counted>();
+    }
+    DuskCheck(Counted::Live == 10);
+
+    arena.Reset();
+    DuskCheck(Counted::Live == 0);
+    DuskCheck(arena.GetBytesUsed() == 0);
+
+    // Fits in what is already there
+    size_t capacity = arena.GetCapacity();
+    arena.Allocate(200);
+    arena.Allocate(900);
+    DuskCheck(arena.GetCapacity() == capacity);
+    arena.Reset();
+}
+
+static void TestOrder()
+{
+    EventQueue queue;
+    Recorder recorder;
+
+    queue.Post(&recorder, TEST_EVENT, ValueEventData(1));
+    queue.Post(&recorder, TEST_EVENT);
+    queue.Post(&recorder, OTHER_EVENT, ValueEventData(2));
+    DuskCheck(queue.GetPendingCount() == 3);
+    DuskCheck(recorder.received.empty());
+
+    queue.Dispatch();
+    DuskCheck((recorder.received == std::vector<int>{ 1, -1, 2 }));
+    DuskCheck(queue.GetPendingCount() == 0);
+
+    // Posted while dispatching waits for the next Dispatch()
+    recorder.received.clear();
+    recorder.repost = true;
+    queue.Post(&recorder, TEST_EVENT, ValueEventData(3));
+    queue.Dispatch();
+    DuskCheck((recorder.received == std::vector<int>{ 3 }));
+    DuskCheck(queue.GetPendingCount() == 1);
+    queue.Dispatch();
+    DuskCheck((recorder.received == std::vector<int>{ 3, 103 }));
+}
+
+static void TestCoalesce()
+{
+    EventQueue queue;
+    Recorder first;
+    Recorder second;
+
+    queue.Post(&first, TEST_EVENT, ValueEventData(1), true);
+    queue.Post(&second, TEST_EVENT, ValueEventData(2), true);
+    queue.Post(&first, OTHER_EVENT, ValueEventData(3), true);
+    queue.Post(&first, TEST_EVENT, ValueEventData(4), true);
+    queue.Post(&first, TEST_EVENT, ValueEventData(5));
+    DuskCheck(queue.GetPendingCount() == 4);
+
+    queue.Dispatch();
+
+    // The coalesced event keeps its place but carries the last payload
+    DuskCheck((first.received == std::vector<int>{ 4, 3, 5 }));
+    DuskCheck((second.received == std::vector<int>{ 2 }));
+
+    // Enough targets to grow the table
+    std::vector<std::unique_ptr<Recorder>> many;
+    for (int i = 0; i < 100; ++i)
+    {
+        many.emplace_back(new Recorder());
+        queue.Post(many.back().get(), TEST_EVENT, ValueEventData(i), true);
+        queue.Post(many.back().get(), TEST_EVENT, ValueEventData(i + 1000), true);
+    }
+    DuskCheck(queue.GetPendingCount() == 100);
+
+    queue.Dispatch();
+
+    bool ok = true;
+    for (int i = 0; i < 100; ++i)
+    {
+        ok &= (many[i]->received == std::vector<int>{ i + 1000 });
+    }
+    DuskCheck(ok);
+}
+
+static void TestCancel()
+{
+    EventQueue queue;
+    Recorder survivor;
+
+    {
+        Recorder doomed;
+        queue.Post(&doomed, TEST_EVENT, ValueEventData(1));
+        queue.Post(&survivor, TEST_EVENT, ValueEventData(2));
+    }
+
+    // Would crash delivering to the destroyed recorder
+    queue.Dispatch();
+    DuskCheck((survivor.received == std::vector<int>{ 2 }));
+}
+
+int main(int argc, char ** argv)
+{
+    TestFrameArena();
+    TestOrder();
+    TestCoalesce();
+    TestCancel();
+
+    return DuskTestResult();
+}
@@ -0,0 +1,170 @@
+// Checks that FramePacer holds the target rate, doesn't rush to catch up
+// after a stall, keeps sleeping after an oversleep, and slows down while idle.
+// Bounds are loose for busy machines.
+
+#include "Test.hpp"
+
+#include <dusk/FramePacer.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace dusk;
+
+typedef std::chrono::steady_clock Clock;
+
+static double MillisecondsSince(Clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count();
+}
+
+static void TestParseMode()
+{
+    FramePacer::Mode mode = FramePacer::Mode::UNCAPPED;
+
+    DuskCheck(FramePacer::ParseMode("VSync", mode) && FramePacer::Mode::VSYNC == mode);
+    DuskCheck(FramePacer::ParseMode("Limited", mode) && FramePacer::Mode::LIMITED == mode);
+    DuskCheck(FramePacer::ParseMode("Uncapped", mode) && FramePacer::Mode::UNCAPPED == mode);
+    DuskCheck(!FramePacer::ParseMode("vsync", mode) && FramePacer::Mode::UNCAPPED == mode);
+
+    FramePacer pacer;
+    pacer.SetTargetFPS(0.0);
+    DuskCheck(60.0 == pacer.GetTargetFPS());
+}
+
+static void TestLimited()
+{
+    const int frameCount = 50;
+
+    FramePacer pacer;
+    pacer.SetMode(FramePacer::Mode::LIMITED);
+    pacer.SetTargetFPS(100.0);
+    pacer.Reset();
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < frameCount; ++i)
+    {
+        pacer.BeginFrame();
+        pacer.EndFrame();
+    }
+
+    // Deadlines follow on from each other, so frames are never early on
+    // average, whatever the sleep granularity
+    double elapsed = MillisecondsSince(start);
+    DuskCheck(elapsed >= frameCount * 10.0 - 1.0);
+    DuskCheck(elapsed < frameCount * 10.0 * 1.5);
+
+    DuskCheck(pacer.GetCurrentFPS() > 70.0 && pacer.GetCurrentFPS() < 110.0);
+    DuskCheck(pacer.GetWaitTime() > 0.0);
+}
+
+static void TestStall()
+{
+    FramePacer pacer;
+    pacer.SetMode(FramePacer::Mode::LIMITED);
+    pacer.SetTargetFPS(100.0);
+    pacer.Reset();
+
+    pacer.BeginFrame();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pacer.EndFrame();
+
+    double stalled = pacer.BeginFrame() * 1000.0;
+    DuskCheck(stalled >= 100.0);
+    pacer.EndFrame();
+
+    // Starts over from the stall rather than running the missed frames back
+    // to back. Single frames can be short after a late wakeup, so check the run
+    double total = 0.0;
+    for (int i = 0; i < 5; ++i)
+    {
+        total += pacer.BeginFrame() * 1000.0;
+        pacer.EndFrame();
+    }
+    DuskCheck(total >= 5 * 10.0 - 5.0);
+}
+
+// Oversleeps once by a lot, as if the thread was descheduled
+class StallingPacer : public FramePacer
+{
+public:
+
+    bool stallNext = false;
+    unsigned int sleepCount = 0;
+
+protected:
+
+    virtual void SleepFor(std::chrono::duration<double, std::milli> duration) override
+    {
+        ++sleepCount;
+        if (stallNext)
+        {
+            stallNext = false;
+            duration += std::chrono::milliseconds(50);
+        }
+        FramePacer::SleepFor(duration);
+    }
+
+}; // class StallingPacer
+
+static void TestOversleep()
+{
+    StallingPacer pacer;
+    pacer.SetMode(FramePacer::Mode::LIMITED);
+    pacer.SetTargetFPS(100.0);
+    pacer.Reset();
+
+    pacer.stallNext = true;
+    for (int i = 0; i < 3; ++i)
+    {
+        pacer.BeginFrame();
+        pacer.EndFrame();
+    }
+    DuskCheck(!pacer.stallNext);
+
+    // One late wakeup, however late, mustn't turn every wait into a spin
+    pacer.sleepCount = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        pacer.BeginFrame();
+        pacer.EndFrame();
+        DuskCheck(pacer.GetWaitTime() > 0.0);
+    }
+    DuskCheck(pacer.sleepCount >= 9);
+}
+
+static void TestUncappedAndIdle()
+{
+    FramePacer pacer;
+    pacer.SetMode(FramePacer::Mode::UNCAPPED);
+    pacer.Reset();
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < 100; ++i)
+    {
+        pacer.BeginFrame();
+        pacer.EndFrame();
+        DuskCheck(0.0 == pacer.GetWaitTime());
+    }
+    DuskCheck(MillisecondsSince(start) < 50.0);
+
+    // Idle frames are slowed even when uncapped
+    pacer.SetIdle(true);
+    pacer.BeginFrame();
+    pacer.EndFrame();
+
+    double frame = pacer.BeginFrame() * 1000.0;
+    DuskCheck(frame >= 1000.0 / FramePacer::IDLE_FPS - 1.0);
+}
+
+int main(int argc, char ** argv)
+{
+    TestParseMode();
+    TestLimited();
+    TestStall();
+    TestOversleep();
+    TestUncappedAndIdle();
+
+    return DuskTestResult();
+}
@@ -0,0 +1,121 @@
+// Checks that ScriptCache reuses bytecode only while the source file is
+// unchanged, both in memory and from the disk cache.
+
+#include "Test.hpp"
+
+#include <dusk/ScriptCache.hpp>
+
+#include <cstdio>
+#include <string>
+
+using namespace dusk;
+
+static const char * SCRIPT_FILE = "ScriptCacheTest.lua";
+
+static void WriteScript(const char * code)
+{
+    FILE * fp = fopen(SCRIPT_FILE, "wb");
+    fputs(code, fp);
+    fclose(fp);
+}
+
+// Loads and runs the script, returning the number it returns or -1
+static lua_Integer Run(ScriptCache& cache, lua_State * L)
+{
+    if (LUA_OK != cache.LoadFile(L, SCRIPT_FILE))
+    {
+        lua_pop(L, 1);
+        return -1;
+    }
+
+    if (LUA_OK != lua_pcall(L, 0, 1, 0))
+    {
+        lua_pop(L, 1);
+        return -1;
+    }
+
+    lua_Integer result = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+    return result;
+}
+
+static void TestMemory(lua_State * L)
+{
+    ScriptCache cache;
+
+    WriteScript("return 1");
+    DuskCheck(Run(cache, L) == 1);
+    DuskCheck(cache.GetMissCount() == 1 && cache.GetHitCount() == 0);
+
+    DuskCheck(Run(cache, L) == 1);
+    DuskCheck(cache.GetMissCount() == 1 && cache.GetHitCount() == 1);
+
+    // Same size and, most likely, the same modification time
+    WriteScript("return 2");
+    DuskCheck(Run(cache, L) == 2);
+    DuskCheck(cache.GetMissCount() == 2);
+
+    WriteScript("return 22");
+    DuskCheck(Run(cache, L) == 22);
+    DuskCheck(cache.GetMissCount() == 3);
+
+    DuskCheck(Run(cache, L) == 22);
+    DuskCheck(cache.GetHitCount() == 2);
+
+    cache.Clear();
+    DuskCheck(Run(cache, L) == 22);
+    DuskCheck(cache.GetMissCount() == 1 && cache.GetHitCount() == 0);
+
+    // A leading # line is skipped, as luaL_loadfile() does
+    WriteScript("#!/usr/bin/lua\nreturn 5");
+    DuskCheck(Run(cache, L) == 5);
+
+    // Missing files fail the same way luaL_loadfile() does
+    remove(SCRIPT_FILE);
+    DuskCheck(Run(cache, L) == -1);
+}
+
+static void TestDisk(lua_State * L)
+{
+    WriteScript("return 333");
+
+    {
+        ScriptCache cache;
+        cache.SetDirectory(".");
+        DuskCheck(Run(cache, L) == 333);
+        DuskCheck(cache.GetMissCount() == 1);
+    }
+
+    // A new cache, as on the next run, finds the bytecode on disk
+    {
+        ScriptCache cache;
+        cache.SetDirectory(".");
+        DuskCheck(Run(cache, L) == 333);
+        DuskCheck(cache.GetMissCount() == 0 && cache.GetHitCount() == 1);
+    }
+
+    // The disk copy is stale once the source changes, even at the same size
+    WriteScript("return 334");
+
+    {
+        ScriptCache cache;
+        cache.SetDirectory(".");
+        DuskCheck(Run(cache, L) == 334);
+        DuskCheck(cache.GetMissCount() == 1 && cache.GetHitCount() == 0);
+    }
+
+    remove(SCRIPT_FILE);
+}
+
+int main(int argc, char ** argv)
+{
+    lua_State * L = luaL_newstate();
+    luaL_openlibs(L);
+
+    TestMemory(L);
+    TestDisk(L);
+
+    lua_close(L);
+
+    return DuskTestResult();
+}
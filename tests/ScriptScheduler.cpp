@@ -0,0 +1,165 @@
+// Checks TimerWheel expiry across wrap-around and long jumps, and that
+// coroutines wake after the frames, seconds or event they waited for, and
+// that the profiler hooks coroutines that are already waiting.
+
+#include "Test.hpp"
+
+#include <dusk/EventDispatcher.hpp>
+#include <dusk/ScriptHost.hpp>
+#include <dusk/ScriptProfiler.hpp>
+#include <dusk/ScriptScheduler.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace dusk;
+
+static const EventID TEST_EVENT = 1;
+
+static void TestTimerWheel()
+{
+    TimerWheel wheel;
+    std::vector<unsigned int> expired;
+
+    auto record = [&](unsigned int id, unsigned int serial) {
+        expired.push_back(id);
+    };
+
+    wheel.Add(3, 1, 0);
+    wheel.Add(3 + TimerWheel::SLOT_COUNT, 2, 0);
+    wheel.Add(10, 3, 0);
+
+    // Shares a slot with id 1 but is a whole turn later
+    wheel.Advance(3, record);
+    DuskCheck(expired.size() == 1 && expired[0] == 1);
+
+    wheel.Advance(9, record);
+    DuskCheck(expired.size() == 1);
+
+    wheel.Advance(10, record);
+    DuskCheck(expired.size() == 2 && expired[1] == 3);
+
+    // Already passed, fires on the next advance
+    wheel.Add(5, 4, 0);
+    wheel.Advance(11, record);
+    DuskCheck(expired.size() == 3 && expired[2] == 4);
+
+    // A jump of more than a turn still catches everything due
+    wheel.Add(300, 5, 0);
+    wheel.Add(2000, 6, 0);
+    wheel.Advance(1000, record);
+    DuskCheck(expired.size() == 5);
+    DuskCheck(expired[3] == 2 || expired[4] == 2);
+    DuskCheck(expired[3] == 5 || expired[4] == 5);
+
+    wheel.Advance(1999, record);
+    DuskCheck(expired.size() == 5);
+    wheel.Advance(2000, record);
+    DuskCheck(expired.size() == 6 && expired[5] == 6);
+
+    // Going backwards does nothing
+    wheel.Advance(10, record);
+    DuskCheck(wheel.GetNow() == 2000);
+}
+
+static lua_Integer GetInteger(lua_State * L, const char * name)
+{
+    lua_getglobal(L, name);
+    lua_Integer value = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+    return value;
+}
+
+static void TestCoroutines()
+{
+    ScriptScheduler& scheduler = ScriptHost::GetScheduler();
+
+    ScriptHost host;
+    lua_State * L = host.GetLuaState();
+
+    IEventDispatcher dispatcher;
+    std::unique_ptr<IEventDispatcher> doomed(new IEventDispatcher());
+
+    sol::state_view lua(L);
+    lua["dispatcher"] = &dispatcher;
+    lua["doomed"] = doomed.get();
+    lua["TEST_EVENT"] = TEST_EVENT;
+
+    DuskCheck(host.RunString(
+        "frames, seconds, yielded, stopped = 0, 0, 0, 0\n"
+        "fired, lost = 0, 0\n"
+        "Dusk.StartCoroutine(function() Dusk.WaitFrames(3); frames = 1 end)\n"
+        "Dusk.StartCoroutine(function() Dusk.WaitSeconds(0.5); seconds = 1 end)\n"
+        "Dusk.StartCoroutine(function() coroutine.yield(); yielded = 1 end)\n"
+        "local handle = Dusk.StartCoroutine(function() Dusk.WaitFrames(1); stopped = 1 end)\n"
+        "Dusk.StopCoroutine(handle)\n"
+        "Dusk.StartCoroutine(function() if Dusk.WaitForEvent(dispatcher, TEST_EVENT) then fired = 1 end end)\n"
+        "Dusk.StartCoroutine(function() if not Dusk.WaitForEvent(doomed, TEST_EVENT) then lost = 1 end end)\n"));
+
+    DuskCheck(scheduler.GetRunningCount() == 5);
+
+    // Quarter seconds add up exactly
+    scheduler.Update(0.25);
+    DuskCheck(GetInteger(L, "yielded") == 1);
+    DuskCheck(GetInteger(L, "frames") == 0);
+    DuskCheck(GetInteger(L, "seconds") == 0);
+    DuskCheck(GetInteger(L, "stopped") == 0);
+
+    // Woken by the event, resumed on the next update
+    dispatcher.DispatchEvent(Event(TEST_EVENT));
+    doomed.reset();
+    DuskCheck(GetInteger(L, "fired") == 0);
+
+    scheduler.Update(0.25);
+    DuskCheck(GetInteger(L, "fired") == 1);
+    DuskCheck(GetInteger(L, "lost") == 1);
+    DuskCheck(GetInteger(L, "seconds") == 1);
+    DuskCheck(GetInteger(L, "frames") == 0);
+
+    scheduler.Update(0.25);
+    DuskCheck(GetInteger(L, "frames") == 1);
+    DuskCheck(GetInteger(L, "stopped") == 0);
+    DuskCheck(scheduler.GetRunningCount() == 0);
+
+    // Waits outside a coroutine are errors, not hangs
+    DuskCheck(!host.RunString("Dusk.WaitFrames(1)"));
+}
+
+static void TestProfilerHooks()
+{
+    ScriptScheduler& scheduler = ScriptHost::GetScheduler();
+    ScriptProfiler& profiler = ScriptHost::GetProfiler();
+
+    ScriptHost host;
+
+    // Already waiting when the profiler starts
+    DuskCheck(host.RunString("Dusk.StartCoroutine(function() Dusk.WaitFrames(10) end)"));
+
+    std::vector<lua_State *> threads = scheduler.GetThreads();
+    DuskCheck(threads.size() == 1);
+
+    profiler.Start();
+    for (lua_State * thread : threads)
+    {
+        DuskCheck(nullptr != lua_gethook(thread));
+    }
+
+    profiler.Stop();
+    for (lua_State * thread : threads)
+    {
+        DuskCheck(nullptr == lua_gethook(thread));
+    }
+
+    profiler.Reset();
+}
+
+int main(int argc, char ** argv)
+{
+    TestTimerWheel();
+
+    IEventDispatcher::InitScripting();
+    TestCoroutines();
+    TestProfilerHooks();
+
+    return DuskTestResult();
+}
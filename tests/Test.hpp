@@ -0,0 +1,21 @@
+#ifndef DUSK_TEST_HPP
+#define DUSK_TEST_HPP
+
+#include <cstdio>
+
+// Each test is its own executable, main() returns DuskTestResult() so ctest
+// sees any failed check
+static int duskTestFailures = 0;
+
+#define DuskCheck(cond)                                                        \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++duskTestFailures;                                                \
+        }                                                                      \
+    } while (0)
+
+#define DuskTestResult() \
+    (duskTestFailures > 0 ? 1 : 0)
+
+#endif // DUSK_TEST_HPP
@@ -0,0 +1,207 @@
+// Checks TransformPool world matrices, change reporting, hierarchy order and
+// render interpolation, and that the parallel path matches the serial one.
+
+#include "Test.hpp"
+
+#include <dusk/TransformPool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace dusk;
+
+static bool Near(const glm::vec3& lhs, const glm::vec3& rhs, float epsilon = 1e-4f)
+{
+    return glm::length(lhs - rhs) < epsilon;
+}
+
+static glm::vec3 Translation(const glm::mat4& world)
+{
+    return glm::vec3(world[3]);
+}
+
+static bool Contains(const std::vector<unsigned int>& list, unsigned int value)
+{
+    return std::find(list.begin(), list.end(), value) != list.end();
+}
+
+static void TestUpdate()
+{
+    TransformPool pool;
+
+    unsigned int a = pool.Allocate();
+    unsigned int b = pool.Allocate();
+
+    pool.Update();
+    DuskCheck(pool.GetChanged().size() == 2);
+
+    pool.Update();
+    DuskCheck(pool.GetChanged().empty());
+
+    unsigned int version = pool.GetVersion(a);
+
+    pool.SetPosition(a, glm::vec3(1.0f, 2.0f, 3.0f));
+    pool.SetScale(a, glm::vec3(2.0f));
+    pool.Update();
+
+    DuskCheck(pool.GetChanged().size() == 1 && Contains(pool.GetChanged(), a));
+    DuskCheck(pool.GetVersion(a) == version + 1);
+    DuskCheck(Near(Translation(pool.GetWorld(a)), glm::vec3(1.0f, 2.0f, 3.0f)));
+    DuskCheck(Near(glm::vec3(pool.GetWorld(a)[0]), glm::vec3(2.0f, 0.0f, 0.0f)));
+
+    // Quarter turn about z takes x onto y
+    pool.SetRotation(b, glm::vec3(0.0f, 0.0f, glm::pi<float>() * 0.5f));
+    pool.Update();
+    DuskCheck(Near(glm::vec3(pool.GetWorld(b) * glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+    float positions[6] = { 4.0f, 0.0f, 0.0f, 0.0f, 5.0f, 0.0f };
+    unsigned int handles[2] = { a, b };
+    pool.SetPositions(handles, 2, positions);
+    pool.Update();
+    DuskCheck(pool.GetChanged().size() == 2);
+    DuskCheck(Near(Translation(pool.GetWorld(b)), glm::vec3(0.0f, 5.0f, 0.0f)));
+}
+
+static void TestHierarchy()
+{
+    TransformPool pool;
+
+    // Allocated child first, so the sort has to move the parent ahead
+    unsigned int child = pool.Allocate();
+    unsigned int parent = pool.Allocate();
+    unsigned int other = pool.Allocate();
+
+    DuskCheck(pool.SetParent(child, parent));
+    DuskCheck(!pool.SetParent(parent, child));
+    DuskCheck(pool.GetParent(parent) == TransformPool::INVALID_HANDLE);
+
+    pool.SetPosition(parent, glm::vec3(1.0f, 0.0f, 0.0f));
+    pool.SetScale(parent, glm::vec3(2.0f));
+    pool.SetPosition(child, glm::vec3(1.0f, 0.0f, 0.0f));
+    pool.Update();
+
+    DuskCheck(pool.GetDepth() == 2);
+    DuskCheck(Near(Translation(pool.GetWorld(child)), glm::vec3(3.0f, 0.0f, 0.0f)));
+
+    // Moving the parent alone reports the child too
+    pool.SetPosition(parent, glm::vec3(0.0f, 1.0f, 0.0f));
+    pool.Update();
+    DuskCheck(Contains(pool.GetChanged(), parent) && Contains(pool.GetChanged(), child));
+    DuskCheck(!Contains(pool.GetChanged(), other));
+    DuskCheck(Near(Translation(pool.GetWorld(child)), glm::vec3(2.0f, 1.0f, 0.0f)));
+
+    // Handles stay valid when another slot is freed
+    pool.Free(other);
+    pool.SetParent(child, TransformPool::INVALID_HANDLE);
+    pool.Update();
+    DuskCheck(pool.GetCount() == 2);
+    DuskCheck(pool.GetDepth() == 1);
+    DuskCheck(Near(Translation(pool.GetWorld(child)), glm::vec3(1.0f, 0.0f, 0.0f)));
+    DuskCheck(Near(Translation(pool.GetWorld(parent)), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+static void TestParallel()
+{
+    const unsigned int count = TransformPool::PARALLEL_THRESHOLD * 3;
+
+    ThreadPool threads(3);
+    TransformPool serial;
+    TransformPool parallel(&threads);
+
+    std::vector<unsigned int> serialHandles;
+    std::vector<unsigned int> parallelHandles;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        serialHandles.push_back(serial.Allocate());
+        parallelHandles.push_back(parallel.Allocate());
+
+        // Chains of four, so every level is large enough to split
+        if (i % 4)
+        {
+            serial.SetParent(serialHandles[i], serialHandles[i - 1]);
+            parallel.SetParent(parallelHandles[i], parallelHandles[i - 1]);
+        }
+
+        glm::vec3 pos((float)(i % 7), (float)(i % 5), (float)(i % 3));
+        serial.SetPosition(serialHandles[i], pos);
+        parallel.SetPosition(parallelHandles[i], pos);
+        serial.SetRotation(serialHandles[i], pos * 0.1f);
+        parallel.SetRotation(parallelHandles[i], pos * 0.1f);
+    }
+
+    serial.Update();
+    parallel.Update();
+
+    DuskCheck(parallel.GetDepth() == 4);
+    DuskCheck(parallel.GetChanged().size() == count);
+
+    bool same = true;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        same &= (serial.GetWorld(serialHandles[i]) == parallel.GetWorld(parallelHandles[i]));
+    }
+    DuskCheck(same);
+}
+
+static void TestInterpolate()
+{
+    TransformPool pool;
+
+    unsigned int moved = pool.Allocate();
+    unsigned int turned = pool.Allocate();
+    unsigned int still = pool.Allocate();
+
+    pool.SetPosition(still, glm::vec3(0.0f, 7.0f, 0.0f));
+    pool.Update();
+
+    pool.SetPosition(moved, glm::vec3(10.0f, 0.0f, 0.0f));
+    pool.SetScale(moved, glm::vec3(3.0f));
+    pool.SetRotation(turned, glm::vec3(0.0f, 0.0f, glm::pi<float>() * 0.5f));
+    pool.Update();
+
+    unsigned int version = pool.GetRenderVersion(moved);
+    unsigned int stillVersion = pool.GetRenderVersion(still);
+
+    pool.Interpolate(0.5f);
+    DuskCheck(pool.GetRenderVersion(moved) == version + 1);
+    DuskCheck(Near(Translation(pool.GetRenderWorld(moved)), glm::vec3(5.0f, 0.0f, 0.0f)));
+    DuskCheck(std::fabs(glm::length(glm::vec3(pool.GetRenderWorld(moved)[0])) - 2.0f) < 1e-4f);
+
+    // Rotations are blended, not the matrix entries, so the axes stay unit length
+    float half = std::sqrt(0.5f);
+    DuskCheck(Near(glm::vec3(pool.GetRenderWorld(turned) * glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)), glm::vec3(half, half, 0.0f)));
+
+    // Slots that didn't change in the last update are left alone
+    DuskCheck(pool.GetRenderVersion(still) == stillVersion);
+    DuskCheck(Near(Translation(pool.GetRenderWorld(still)), glm::vec3(0.0f, 7.0f, 0.0f)));
+
+    // The same alpha twice does nothing
+    pool.Interpolate(0.5f);
+    DuskCheck(pool.GetRenderVersion(moved) == version + 1);
+
+    pool.Interpolate(0.0f);
+    DuskCheck(Near(Translation(pool.GetRenderWorld(moved)), glm::vec3(0.0f, 0.0f, 0.0f)));
+
+    // Clamped, and 1 is exactly the world matrix
+    pool.Interpolate(2.0f);
+    DuskCheck(pool.GetRenderWorld(moved) == pool.GetWorld(moved));
+    DuskCheck(pool.GetRenderWorld(turned) == pool.GetWorld(turned));
+
+    // An update without changes leaves the render matrices on the latest state
+    pool.Interpolate(0.25f);
+    pool.Update();
+    DuskCheck(pool.GetChanged().empty());
+    DuskCheck(pool.GetRenderWorld(moved) == pool.GetWorld(moved));
+}
+
+int main(int argc, char ** argv)
+{
+    TestUpdate();
+    TestHierarchy();
+    TestParallel();
+    TestInterpolate();
+
+    return DuskTestResult();
+}